@@ -56,6 +56,9 @@ class LLMEngine:
     def is_finished(self):
         return self.scheduler.is_finished()
 
+    def abort_all(self):
+        self.scheduler.abort_all()
+
     def generate(
         self,
         prompts: list[str] | list[list[int]],
@@ -31,6 +31,52 @@ def split_text_into_chunks(text: str):
         
     return chunks
 
+SPECULATE_PREFIX = "SPECULATE::"
+
+
+def parse_speculative_request(text: str):
+    """推测请求 "SPECULATE::<推测编号> <文本>" 返回 (编号, 文本)，普通请求返回 (None, 文本)"""
+    if not text.startswith(SPECULATE_PREFIX):
+        return None, text
+    speculation_id, _, body = text[len(SPECULATE_PREFIX):].partition(" ")
+    return speculation_id, body
+
+
+def drain_control(control_socket, speculation_id=None):
+    """非阻塞地读取所有控制消息，返回 (cancelled, discarded)：
+    cancelled 为收到取消 (用户打断播放)，discarded 为推测请求 speculation_id 已被丢弃 (最终文本不同或被取代)。
+    其他推测编号的 CONTROL::DISCARD 是迟到的旧消息，忽略"""
+    cancelled = False
+    discarded = False
+    while True:
+        try:
+            message = control_socket.recv_string(zmq.NOBLOCK)
+        except zmq.Again:
+            return cancelled, discarded
+        if message.startswith("CONTROL::CANCEL"):
+            print(f"[取消] 收到 {message}")
+            cancelled = True
+        elif message.startswith("CONTROL::DISCARD"):
+            parts = message.split()
+            if speculation_id is not None and len(parts) >= 3 and parts[2] == speculation_id:
+                print(f"[推测] 收到 {message}")
+                discarded = True
+
+
+def generate_cancellable(llm, prompt, sampling_params, control_socket, speculation_id=None):
+    """逐步解码，每步之间检查控制消息；被取消或推测请求被丢弃时立即释放KV缓存并返回 None"""
+    llm.add_request(prompt, sampling_params)
+    token_ids = []
+    while not llm.is_finished():
+        if any(drain_control(control_socket, speculation_id)):
+            llm.abort_all()
+            return None
+        output, _ = llm.step()
+        for _, ids in output:
+            token_ids = ids
+    return llm.tokenizer.decode(token_ids)
+
+
 def main():
     # --- 1. 初始化LLM ---
     path = os.path.expanduser("C:\\vllm_nano\\nano-vllm-main\\Qwen3-0.6B\\")
@@ -51,29 +97,68 @@ def main():
     linux_vm_ip = "192.168.118.128" # <--- 在这里修改IP地址
     tts_socket = context.socket(zmq.REQ)
     tts_socket.connect(f"tcp://{linux_vm_ip}:7777")
+
+    # c. 订阅语音助手的控制消息 (端口 6690)：用户打断播放时停止生成和发送
+    control_socket = context.socket(zmq.SUB)
+    control_socket.connect(f"tcp://{linux_vm_ip}:6690")
+    control_socket.setsockopt_string(zmq.SUBSCRIBE, "CONTROL::")
     
     print(f"\n===== LLM服务已启动 (最终架构) =====")
     print(f"  -> 正在监听端口 6666 (用于接收ASR请求)")
     print(f"  -> 准备连接到TTS服务 at tcp://{linux_vm_ip}:7777")
 
+    # 推测请求生成的回答 (文本, 分块)：只生成不播放，等到文本相同的普通请求 (命中) 才送TTS
+    held = None
+
     try:
         while True:
             # --- 3. 接收ASR请求 ---
             print("\n等待来自ASR的文本...")
-            received_text = asr_socket.recv_string()
+            speculation_id, received_text = parse_speculative_request(asr_socket.recv_string())
+            # 本次请求之前的取消消息针对的是上一个回答；推测请求可能在到达之前就已被丢弃
+            _, discarded = drain_control(control_socket, speculation_id)
+
+            if speculation_id is not None:
+                print(f"[收到推测请求 {speculation_id}] 文本: '{received_text}'")
+                held = None
+                response_text = None
+                if not discarded:
+                    formatted_prompt = tokenizer.apply_chat_template(
+                        [{"role": "user", "content": received_text}],
+                        tokenize=False, add_generation_prompt=True, enable_thinking=False
+                    )
+                    response_text = generate_cancellable(llm, formatted_prompt, sampling_params,
+                                                         control_socket, speculation_id)
+                if response_text is None:
+                    # 回复即表示已停止生成，客户端此后才发送下一个请求
+                    asr_socket.send_string("已取消。")
+                    continue
+                held = (received_text, split_text_into_chunks(response_text))
+                print(f"[推测] 已生成，等待确认: {held[1]}")
+                asr_socket.send_string("已生成，等待确认。")
+                continue
+
             print(f"[收到ASR] 文本: '{received_text}'")
+            if held is not None and held[0] == received_text:
+                # 推测命中：直接播放已生成的回答
+                chunks = held[1]
+                held = None
+                print(f"[推测命中] 使用已生成的回复: {chunks}")
+            else:
+                held = None
+                # --- 4. 调用LLM生成完整回答 ---
+                formatted_prompt = tokenizer.apply_chat_template(
+                    [{"role": "user", "content": received_text}],
+                    tokenize=False, add_generation_prompt=True, enable_thinking=False
+                )
+                response_text = generate_cancellable(llm, formatted_prompt, sampling_params, control_socket)
+                if response_text is None:
+                    asr_socket.send_string("已取消。")
+                    continue
 
-            # --- 4. 调用LLM生成完整回答 ---
-            formatted_prompt = tokenizer.apply_chat_template(
-                [{"role": "user", "content": received_text}],
-                tokenize=False, add_generation_prompt=True, enable_thinking=False
-            )
-            outputs = llm.generate([formatted_prompt], sampling_params)
-            response_text = outputs[0]['text']
-            
-            # --- 5. 将回答分块并通过ZMQ流式发送给TTS服务 ---
-            chunks = split_text_into_chunks(response_text)
-            print(f"[LLM生成] 清理并分块后的回复: {chunks}")
+                # --- 5. 将回答分块并通过ZMQ流式发送给TTS服务 ---
+                chunks = split_text_into_chunks(response_text)
+                print(f"[LLM生成] 清理并分块后的回复: {chunks}")
             
             if not chunks:
                 asr_socket.send_string("LLM无有效回复。")
@@ -81,12 +166,21 @@ def main():
 
             try:
                 # 循环发送所有文本块到数据端口 7777
+                cancelled = False
                 for i, chunk in enumerate(chunks):
+                    if drain_control(control_socket)[0]:
+                        cancelled = True
+                        break
                     print(f"[发送TTS] 发送块 {i+1}/{len(chunks)}: '{chunk}'...")
                     tts_socket.send_string(chunk)
                     # 等待TTS的简单确认("OK")，然后才能发送下一条
                     reply = tts_socket.recv_string() 
                 
+                if cancelled:
+                    print("[取消] 用户打断，剩余文本块不再发送。")
+                    asr_socket.send_string("已取消。")
+                    continue
+
                 # 全部发送成功后，立即回复给ASR客户端
                 print("[完成] 所有文本块已成功发送至TTS。")
                 asr_socket.send_string("回答已发送至TTS进行播放。")
@@ -100,6 +194,7 @@ def main():
     finally:
         asr_socket.close()
         tts_socket.close()
+        control_socket.close()
         context.term()
 
 if __name__ == "__main__":
@@ -0,0 +1,193 @@
+// asr_batch_server.cpp
+// 多路流式识别服务端：共享识别器 + 跨会话批量解码
+
+#include "asr_batch_server.h"
+#include "asr_model.h"
+#include <algorithm>
+#include <tuple>
+#include <sherpa-onnx/c-api/c-api.h>
+
+using namespace sherpa_onnx::cxx;
+
+AsrBatchServer::AsrBatchServer(const BatchServerOptions& options, ResultCallback on_result)
+    : options_(options),
+      on_result_(std::move(on_result))
+{
+    OnlineRecognizerConfig config = make_online_recognizer_config(options_.model_dir, options_.num_threads);
+    config.enable_endpoint = true;
+    config.rule1_min_trailing_silence = options_.rule1_min_trailing_silence;
+    config.rule2_min_trailing_silence = options_.rule2_min_trailing_silence;
+    config.rule3_min_utterance_length = options_.rule3_min_utterance_length;
+    recognizer_ = std::make_unique<OnlineRecognizer>(OnlineRecognizer::Create(config));
+
+    if (options_.max_batch == 0) {
+        options_.max_batch = 1;
+    }
+    batch_streams_.reserve(options_.max_batch);
+    batch_sessions_.reserve(options_.max_batch);
+    std::cout << "[Batch] 多路识别服务端已就绪 (单批最多 " << options_.max_batch << " 路)" << std::endl;
+}
+
+AsrBatchServer::SessionId AsrBatchServer::open_session(const std::string& name) {
+    SessionId id = ++next_session_id_;
+    sessions_.emplace(std::piecewise_construct, std::forward_as_tuple(id),
+                      std::forward_as_tuple(recognizer_->CreateStream(),
+                                            name.empty() ? "会话" + std::to_string(id) : name));
+    ++sessions_opened_;
+    return id;
+}
+
+bool AsrBatchServer::accept(SessionId id, const float* samples, size_t n) {
+    auto it = sessions_.find(id);
+    if (it == sessions_.end() || it->second.closing) {
+        return false;
+    }
+    Session& session = it->second;
+    if (session.finishing) {
+        // 上一句的尾部还没有随批量解码完成，先单独解码完毕再接收新的一句
+        while (recognizer_->IsReady(&session.stream)) {
+            recognizer_->Decode(&session.stream);
+        }
+        complete(it);
+    }
+    session.stream.AcceptWaveform(sample_rate_, samples, static_cast<int32_t>(n));
+    session.samples += n;
+    total_samples_ += n;
+    if (!session.has_pending) {
+        session.has_pending = true;
+        session.pending_since = std::chrono::steady_clock::now();
+    }
+    return true;
+}
+
+void AsrBatchServer::finish_utterance(SessionId id) {
+    auto it = sessions_.find(id);
+    if (it == sessions_.end() || it->second.finishing || it->second.closing) {
+        return;
+    }
+    it->second.stream.InputFinished();
+    it->second.finishing = true;
+    ++finishing_sessions_;
+}
+
+void AsrBatchServer::close_session(SessionId id) {
+    auto it = sessions_.find(id);
+    if (it == sessions_.end() || it->second.closing) {
+        return;
+    }
+    if (!it->second.finishing) {
+        it->second.stream.InputFinished();
+        ++finishing_sessions_;
+    }
+    it->second.closing = true;
+}
+
+size_t AsrBatchServer::decode_ready() {
+    batch_streams_.clear();
+    batch_sessions_.clear();
+    for (auto it = sessions_.begin(); it != sessions_.end() && batch_streams_.size() < options_.max_batch; ++it) {
+        if (recognizer_->IsReady(&it->second.stream)) {
+            batch_streams_.push_back(it->second.stream.Get());
+            batch_sessions_.push_back(it);
+        }
+    }
+
+    const size_t n = batch_streams_.size();
+    if (n > 0) {
+        // 一次调用解码所有就绪的流：编码器以 batch=n 运行一次前向
+        auto t0 = std::chrono::steady_clock::now();
+        SherpaOnnxDecodeMultipleOnlineStreams(recognizer_->Get(), batch_streams_.data(),
+                                              static_cast<int32_t>(n));
+        auto now = std::chrono::steady_clock::now();
+        decode_seconds_ += std::chrono::duration<double>(now - t0).count();
+        ++batches_;
+        streams_decoded_ += n;
+        max_batch_seen_ = std::max(max_batch_seen_, n);
+
+        for (auto it : batch_sessions_) {
+            Session& session = it->second;
+            if (session.has_pending && !recognizer_->IsReady(&session.stream)) {
+                // 已到达的音频全部解码完毕
+                double lag_ms = std::chrono::duration<double, std::milli>(now - session.pending_since).count();
+                session.decode_lag.add(lag_ms);
+                all_decode_lag_.add(lag_ms);
+                session.has_pending = false;
+            }
+            if (!session.finishing && !session.closing && recognizer_->IsEndpoint(&session.stream)) {
+                emit_result(it->first, session);
+                recognizer_->Reset(&session.stream);
+            }
+        }
+    }
+
+    // 输入已结束且尾部解码完毕的流：输出最后一句
+    if (finishing_sessions_ > 0) {
+        for (auto it = sessions_.begin(); it != sessions_.end();) {
+            auto current = it++;
+            if ((current->second.finishing || current->second.closing) &&
+                !recognizer_->IsReady(&current->second.stream)) {
+                complete(current);
+            }
+        }
+    }
+    return n;
+}
+
+size_t AsrBatchServer::drain() {
+    size_t batches = 0;
+    while (decode_ready() > 0) {
+        ++batches;
+    }
+    return batches;
+}
+
+void AsrBatchServer::emit_result(SessionId id, Session& session) {
+    auto result = recognizer_->GetResult(&session.stream);
+    if (result.text.empty()) {
+        return;
+    }
+    ++session.utterances;
+    ++total_utterances_;
+    if (on_result_) {
+        on_result_(id, session.name, result.text);
+    }
+}
+
+void AsrBatchServer::complete(std::map<SessionId, Session>::iterator it) {
+    Session& session = it->second;
+    emit_result(it->first, session);
+    --finishing_sessions_;
+    if (session.closing) {
+        finished_session_lag_.merge(session.decode_lag);
+        sessions_.erase(it);
+        return;
+    }
+    session.stream = recognizer_->CreateStream();
+    session.finishing = false;
+    session.has_pending = false;
+}
+
+void AsrBatchServer::print_stats(std::ostream& os) const {
+    double audio_seconds = static_cast<double>(total_samples_) / sample_rate_;
+    os << "\n===== 多路识别统计 =====" << std::endl;
+    os << "[Batch] 会话 " << sessions_opened_ << " 路 (进行中 " << sessions_.size() << ")，音频共 "
+       << audio_seconds << " 秒，识别 " << total_utterances_ << " 句" << std::endl;
+    os << "[Batch] 批量解码 " << batches_ << " 次，平均每批 "
+       << (batches_ ? static_cast<double>(streams_decoded_) / batches_ : 0.0)
+       << " 路，最大 " << max_batch_seen_ << " 路，解码耗时 " << decode_seconds_ << " 秒" << std::endl;
+    if (audio_seconds > 0) {
+        double rtf = decode_seconds_ / audio_seconds;
+        os << "[Batch] 总实时率 RTF = " << rtf << " (解码耗时 / 所有会话音频总时长)";
+        if (rtf > 0) {
+            os << "，按此估算可实时服务约 " << static_cast<int>(1.0 / rtf) << " 路";
+        }
+        os << std::endl;
+    }
+    all_decode_lag_.print(os);
+    if (finished_session_lag_.count() > 0) {
+        finished_session_lag_.print(os);
+    }
+    for (const auto& entry : sessions_) {
+        entry.second.decode_lag.print(os);
+    }
+}
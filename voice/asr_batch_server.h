@@ -0,0 +1,105 @@
+// asr_batch_server.h
+// 多路流式识别服务端核心：所有会话共用一个 OnlineRecognizer，每路会话一个 OnlineStream。
+// 解码时把所有已就绪的流收集起来一次批量解码 (编码器一次前向处理 N 路)，
+// 而不是逐路串行调用，使一台机器可以同时服务几十路音频。
+// 非线程安全：接收音频、解码都须在同一线程中调用。
+#ifndef ASR_BATCH_SERVER_H
+#define ASR_BATCH_SERVER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sherpa-onnx/c-api/cxx-api.h>
+#include "latency_stats.h"
+
+struct BatchServerOptions {
+    std::string model_dir;
+    int num_threads = 4;
+    size_t max_batch = 32;              // 单次批量解码的最大流数
+
+    // 识别器端点规则 (秒)：每路会话各自判断一句话何时结束
+    float rule1_min_trailing_silence = 2.4f;   // 尚未识别出内容时的尾部静音
+    float rule2_min_trailing_silence = 0.8f;   // 已识别出内容后的尾部静音
+    float rule3_min_utterance_length = 20.0f;  // 单句最长时长
+};
+
+class AsrBatchServer {
+public:
+    using SessionId = uint64_t;
+    // 某路会话识别出完整一句话 (端点触发、finish_utterance 或会话结束) 时调用
+    using ResultCallback = std::function<void(SessionId session, const std::string& name,
+                                              const std::string& text)>;
+
+    AsrBatchServer(const BatchServerOptions& options, ResultCallback on_result);
+
+    SessionId open_session(const std::string& name = "");
+    // 送入一路会话的音频 (16kHz 单声道 float)，会话不存在或已关闭时返回 false
+    bool accept(SessionId session, const float* samples, size_t n);
+    // 当前一句话的输入结束 (如外部 VAD 判定语音结束)：尾部解码完成后输出结果，
+    // 会话换用新的流继续接收下一句
+    void finish_utterance(SessionId session);
+    // 输入结束：尾部解码完成后输出最后一句并释放该会话
+    void close_session(SessionId session);
+
+    // 对所有已就绪的流做一次批量解码，返回本批解码的流数 (0 表示没有可解码的流)
+    size_t decode_ready();
+    // 反复批量解码直到没有就绪的流，返回批次数
+    size_t drain();
+
+    size_t session_count() const { return sessions_.size(); }
+    int sample_rate() const { return sample_rate_; }
+    void print_stats(std::ostream& os = std::cout) const;
+
+private:
+    struct Session {
+        Session(sherpa_onnx::cxx::OnlineStream s, std::string session_name)
+            : stream(std::move(s)), name(std::move(session_name)),
+              decode_lag(name + " 音频到达→解码完成") {}
+
+        sherpa_onnx::cxx::OnlineStream stream;
+        std::string name;
+        bool finishing = false;   // 当前流已 InputFinished，等待尾部解码完成
+        bool closing = false;
+        uint64_t samples = 0;
+        uint64_t utterances = 0;
+        // 尚未解码的音频中最早一块的到达时间
+        bool has_pending = false;
+        std::chrono::steady_clock::time_point pending_since;
+        LatencyHistogram decode_lag;
+    };
+
+    void emit_result(SessionId id, Session& session);
+    // 尾部已解码完毕的流：输出结果，关闭的会话被释放，其余换用新的流
+    void complete(std::map<SessionId, Session>::iterator it);
+
+    BatchServerOptions options_;
+    ResultCallback on_result_;
+    int sample_rate_ = 16000;
+    std::unique_ptr<sherpa_onnx::cxx::OnlineRecognizer> recognizer_;
+
+    std::map<SessionId, Session> sessions_;
+    SessionId next_session_id_ = 0;
+    size_t finishing_sessions_ = 0;   // finishing 或 closing 的会话数
+
+    // 每批复用的缓冲区
+    std::vector<const SherpaOnnxOnlineStream*> batch_streams_;
+    std::vector<std::map<SessionId, Session>::iterator> batch_sessions_;
+
+    // 统计
+    uint64_t batches_ = 0;
+    uint64_t streams_decoded_ = 0;
+    size_t max_batch_seen_ = 0;
+    uint64_t total_samples_ = 0;
+    uint64_t total_utterances_ = 0;
+    uint64_t sessions_opened_ = 0;
+    double decode_seconds_ = 0.0;
+    LatencyHistogram all_decode_lag_{"所有会话 音频到达→解码完成"};
+    LatencyHistogram finished_session_lag_{"已结束会话 音频到达→解码完成"};   // 结束时合并进来
+};
+
+#endif // ASR_BATCH_SERVER_H
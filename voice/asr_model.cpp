@@ -0,0 +1,192 @@
+// asr_model.cpp
+// 流式识别模型的公共配置
+
+#include "asr_model.h"
+#include <algorithm>
+#include <chrono>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace sherpa_onnx::cxx;
+
+namespace {
+
+void set_transducer_files(OnlineRecognizerConfig& config, const std::string& model_dir, const char* suffix) {
+    config.model_config.transducer.encoder = model_dir + "/encoder-epoch-99-avg-1" + suffix;
+    config.model_config.transducer.decoder = model_dir + "/decoder-epoch-99-avg-1" + suffix;
+    config.model_config.transducer.joiner = model_dir + "/joiner-epoch-99-avg-1" + suffix;
+}
+
+// 目录中以 prefix 开头的 .onnx 文件，优先 .int8.onnx；找不到时返回空串
+std::string find_model_file(const std::string& dir, const std::string& prefix) {
+    std::vector<std::string> fp32;
+    std::vector<std::string> int8;
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* entry = readdir(d)) {
+            std::string name = entry->d_name;
+            if (name.compare(0, prefix.size(), prefix) != 0 || name.size() < 5 ||
+                name.compare(name.size() - 5, 5, ".onnx") != 0) {
+                continue;
+            }
+            bool quantized = name.size() > 10 && name.compare(name.size() - 10, 10, ".int8.onnx") == 0;
+            (quantized ? int8 : fp32).push_back(dir + "/" + name);
+        }
+        closedir(d);
+    }
+    const auto& candidates = int8.empty() ? fp32 : int8;
+    return candidates.empty() ? std::string() : *std::min_element(candidates.begin(), candidates.end());
+}
+
+} // namespace
+
+const char* precision_name(ModelPrecision precision) {
+    switch (precision) {
+    case ModelPrecision::Int8: return "int8";
+    case ModelPrecision::Fp32: return "fp32";
+    default: return "auto";
+    }
+}
+
+bool parse_precision(const std::string& name, ModelPrecision& precision) {
+    if (name == "int8") {
+        precision = ModelPrecision::Int8;
+    } else if (name == "fp32") {
+        precision = ModelPrecision::Fp32;
+    } else if (name == "auto") {
+        precision = ModelPrecision::Auto;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+OnlineRecognizerConfig make_online_recognizer_config(const std::string& model_dir, int num_threads,
+                                                     ModelPrecision precision) {
+    OnlineRecognizerConfig config;
+    config.model_config.tokens = model_dir + "/tokens.txt";
+
+    if (precision == ModelPrecision::Fp32) {
+        set_transducer_files(config, model_dir, ".onnx");
+        if (!model_file_exists(config.model_config.transducer.encoder)) {
+            std::cout << "未找到fp32模型，改用int8量化模型..." << std::endl;
+            set_transducer_files(config, model_dir, ".int8.onnx");
+        } else {
+            std::cout << "使用fp32模型" << std::endl;
+        }
+    } else {
+        set_transducer_files(config, model_dir, ".int8.onnx");
+        if (!model_file_exists(config.model_config.transducer.encoder)) {
+            std::cout << "未找到int8量化模型，尝试使用fp32模型..." << std::endl;
+            set_transducer_files(config, model_dir, ".onnx");
+        } else {
+            std::cout << "使用int8量化模型以提高性能" << std::endl;
+        }
+    }
+
+    config.model_config.num_threads = num_threads;
+    return config;
+}
+
+std::vector<ModelPrecision> available_precisions(const std::string& model_dir) {
+    std::vector<ModelPrecision> result;
+    if (model_file_exists(model_dir + "/encoder-epoch-99-avg-1.int8.onnx")) {
+        result.push_back(ModelPrecision::Int8);
+    }
+    if (model_file_exists(model_dir + "/encoder-epoch-99-avg-1.onnx")) {
+        result.push_back(ModelPrecision::Fp32);
+    }
+    return result;
+}
+
+VadModelConfig make_vad_config(const std::string& model_path, int sample_rate, float min_silence_duration) {
+    VadModelConfig config;
+    config.silero_vad.model = model_path;
+    config.sample_rate = sample_rate;
+    config.silero_vad.threshold = 0.5;
+    config.silero_vad.min_speech_duration = 0.25;
+    config.silero_vad.min_silence_duration = min_silence_duration;
+    config.silero_vad.window_size = 512;
+    return config;
+}
+
+KeywordSpotterConfig make_keyword_spotter_config(const std::string& model_dir,
+                                                 const std::string& keywords_file,
+                                                 int num_threads) {
+    KeywordSpotterConfig config;
+    config.model_config.transducer.encoder = find_model_file(model_dir, "encoder");
+    config.model_config.transducer.decoder = find_model_file(model_dir, "decoder");
+    config.model_config.transducer.joiner = find_model_file(model_dir, "joiner");
+    config.model_config.tokens = model_dir + "/tokens.txt";
+    config.model_config.num_threads = num_threads;
+    config.keywords_file = keywords_file.empty() ? model_dir + "/keywords.txt" : keywords_file;
+
+    if (config.model_config.transducer.encoder.empty()) {
+        std::cerr << "错误：KWS模型目录中未找到 encoder*.onnx: " << model_dir << std::endl;
+    }
+    if (!model_file_exists(config.keywords_file)) {
+        std::cerr << "错误：关键词文件不存在: " << config.keywords_file << std::endl;
+    }
+    return config;
+}
+
+bool model_file_exists(const std::string& path) {
+    struct stat st;
+    return !path.empty() && stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+std::vector<std::string> model_files(const OnlineRecognizerConfig& config) {
+    const auto& model = config.model_config;
+    return {model.transducer.encoder, model.transducer.decoder, model.transducer.joiner, model.tokens};
+}
+
+std::vector<std::string> model_files(const KeywordSpotterConfig& config) {
+    const auto& model = config.model_config;
+    return {model.transducer.encoder, model.transducer.decoder, model.transducer.joiner, model.tokens,
+            config.keywords_file};
+}
+
+PrefetchStats prefetch_model_files(const std::vector<std::string>& paths) {
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<int64_t> bytes(paths.size(), -1);
+    std::vector<std::thread> readers;
+    readers.reserve(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        readers.emplace_back([&paths, &bytes, i] {
+            int fd = open(paths[i].c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                return;
+            }
+            // 先让内核按顺序异步预读，再实际读一遍，确保返回时文件已全部在页缓存中
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            std::vector<char> buffer(1 << 20);
+            int64_t total = 0;
+            ssize_t n;
+            while ((n = pread(fd, buffer.data(), buffer.size(), total)) > 0) {
+                total += n;
+            }
+            close(fd);
+            bytes[i] = total;
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    PrefetchStats stats;
+    for (int64_t b : bytes) {
+        if (b < 0) {
+            ++stats.missing;
+        } else {
+            ++stats.files;
+            stats.bytes += static_cast<uint64_t>(b);
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return stats;
+}
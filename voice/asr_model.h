@@ -0,0 +1,55 @@
+// asr_model.h
+// 流式识别与 VAD 模型的公共配置：AudioMonitor 与多路识别服务端共用同一套模型配置
+#ifndef ASR_MODEL_H
+#define ASR_MODEL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sherpa-onnx/c-api/cxx-api.h>
+
+enum class ModelPrecision {
+    Auto,   // 有 int8 量化模型时使用 int8，否则 fp32
+    Int8,
+    Fp32
+};
+
+const char* precision_name(ModelPrecision precision);
+bool parse_precision(const std::string& name, ModelPrecision& precision);
+
+// 按模型目录构造在线识别器配置。指定的精度不存在时退回另一种
+sherpa_onnx::cxx::OnlineRecognizerConfig make_online_recognizer_config(const std::string& model_dir,
+                                                                       int num_threads,
+                                                                       ModelPrecision precision = ModelPrecision::Auto);
+
+// 模型目录中实际存在的精度 (int8 在前)
+std::vector<ModelPrecision> available_precisions(const std::string& model_dir);
+
+// Silero VAD 配置 (阈值、最短语音时长与单机版一致；静音时长默认同为 0.5 秒)
+sherpa_onnx::cxx::VadModelConfig make_vad_config(const std::string& model_path, int sample_rate,
+                                                  float min_silence_duration = 0.5f);
+
+// 关键词检测 (唤醒词) 配置。KWS 模型的文件名带训练参数 (如 encoder-epoch-12-avg-2-chunk-16-left-64.onnx)，
+// 按前缀在目录中查找，优先 int8。keywords_file 为空时使用模型目录下的 keywords.txt
+sherpa_onnx::cxx::KeywordSpotterConfig make_keyword_spotter_config(const std::string& model_dir,
+                                                                   const std::string& keywords_file,
+                                                                   int num_threads);
+
+// 模型文件是否存在 (只做 stat，不打开文件)
+bool model_file_exists(const std::string& path);
+
+// 配置中引用的模型与词表文件
+std::vector<std::string> model_files(const sherpa_onnx::cxx::OnlineRecognizerConfig& config);
+std::vector<std::string> model_files(const sherpa_onnx::cxx::KeywordSpotterConfig& config);
+
+struct PrefetchStats {
+    size_t files = 0;
+    size_t missing = 0;
+    uint64_t bytes = 0;
+    double seconds = 0.0;
+};
+
+// 每个文件一个线程并行读入页缓存，创建 ONNX 会话时即从内存读取；慢速存储 (eMMC/SD卡) 上可明显缩短启动时间
+PrefetchStats prefetch_model_files(const std::vector<std::string>& paths);
+
+#endif // ASR_MODEL_H
@@ -0,0 +1,177 @@
+// asr_server_main.cpp
+// 多路流式识别服务端程序。
+// --listen：接收远程采集端通过 ZMQ 发送的 PCM 音频 (见 pcm_ingest.h)，每个会话独立 VAD + 识别。
+// --bench：用 WAV 文件模拟 N 路并发会话，测量批量解码的总实时率与每路延迟。
+
+#include "asr_batch_server.h"
+#include "pcm_ingest_server.h"
+#include "wav_file_source.h"
+#include <atomic>
+#include <chrono>
+#include <signal.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<bool> g_running(true);
+
+void signal_handler(int signal) {
+    if (signal == SIGINT || signal == SIGTERM) {
+        std::cout << "\n\n程序被用户中断" << std::endl;
+        g_running = false;
+    }
+}
+
+struct BenchSession {
+    AsrBatchServer::SessionId id;
+    std::unique_ptr<WavFileSource> source;
+    bool finished = false;
+};
+
+// 每路会话从不同的文件开始回放同一组 WAV，以 100ms 为一拍送入服务端，每拍之后批量解码
+int run_bench(AsrBatchServer& server, const std::vector<std::string>& wav_paths, int sessions, bool fast) {
+    std::vector<std::string> files = WavFileSource::expand_paths(wav_paths);
+    if (files.empty()) {
+        std::cerr << "错误：--bench 需要通过 --wav 指定音频文件或目录" << std::endl;
+        return -1;
+    }
+
+    std::vector<BenchSession> bench;
+    for (int i = 0; i < sessions; ++i) {
+        std::vector<std::string> rotated;
+        for (size_t k = 0; k < files.size(); ++k) {
+            rotated.push_back(files[(i + k) % files.size()]);
+        }
+        BenchSession session;
+        session.source = std::make_unique<WavFileSource>(rotated, WavFileSource::Pacing::AsFastAsPossible);
+        if (!session.source->start()) {
+            return -1;
+        }
+        if (session.source->sample_rate() != server.sample_rate()) {
+            std::cerr << "错误：WAV采样率 " << session.source->sample_rate() << " 与模型要求的 "
+                      << server.sample_rate() << " 不一致" << std::endl;
+            return -1;
+        }
+        session.id = server.open_session("会话" + std::to_string(i + 1));
+        bench.push_back(std::move(session));
+    }
+
+    std::cout << "[Bench] " << sessions << " 路并发会话，" << (fast ? "尽可能快" : "实时节奏") << "送入音频"
+              << std::endl;
+    const size_t tick_samples = server.sample_rate() / 10;
+    const auto start = std::chrono::steady_clock::now();
+    size_t active = bench.size();
+    for (uint64_t tick = 1; active > 0; ++tick) {
+        for (auto& session : bench) {
+            if (session.finished) {
+                continue;
+            }
+            AudioFrame frame;
+            ReadStatus status = session.source->read(frame, tick_samples, 0);
+            if (status == ReadStatus::Ok) {
+                server.accept(session.id, frame.data, frame.size);
+            } else if (status == ReadStatus::Finished || status == ReadStatus::Error) {
+                server.close_session(session.id);
+                session.finished = true;
+                --active;
+            }
+        }
+        server.drain();
+        if (!fast) {
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(100 * tick));
+        }
+    }
+    // 等待所有会话的尾部解码完成
+    while (server.session_count() > 0 && server.decode_ready() > 0) {
+    }
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[Bench] 墙上时间 " << wall << " 秒" << std::endl;
+    server.print_stats();
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BatchServerOptions options;
+    options.model_dir = "./models/sherpa-onnx-streaming-zipformer-small-bilingual-zh-en-2023-02-16";
+    IngestOptions ingest;
+    bool listen_mode = false;
+    std::vector<std::string> wav_paths;
+    int bench_sessions = 0;
+    bool fast = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--model-dir" && i + 1 < argc) {
+            options.model_dir = argv[++i];
+        } else if (arg == "--vad-model" && i + 1 < argc) {
+            ingest.vad_model_path = argv[++i];
+        } else if (arg == "--listen" && i + 1 < argc) {
+            listen_mode = true;
+            ingest.address = argv[++i];
+        } else if (arg == "--idle-seconds" && i + 1 < argc) {
+            ingest.session_idle_seconds = std::stof(argv[++i]);
+        } else if (arg == "--no-vad-gate") {
+            ingest.vad_gate.enabled = false;
+        } else if (arg == "--vad-gate-margin" && i + 1 < argc) {
+            ingest.vad_gate.margin_db = std::stof(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.num_threads = std::stoi(argv[++i]);
+        } else if (arg == "--max-batch" && i + 1 < argc) {
+            options.max_batch = std::stoul(argv[++i]);
+        } else if (arg == "--bench" && i + 1 < argc) {
+            bench_sessions = std::stoi(argv[++i]);
+        } else if (arg == "--wav" && i + 1 < argc) {
+            wav_paths.push_back(argv[++i]);
+        } else if (arg == "--fast") {
+            fast = true;
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "用法: " << argv[0] << " [选项]" << std::endl;
+            std::cout << "选项:" << std::endl;
+            std::cout << "  --model-dir DIR            流式识别模型目录" << std::endl;
+            std::cout << "  --threads N                识别器推理线程数 (默认 4)" << std::endl;
+            std::cout << "  --max-batch N              单次批量解码的最大路数 (默认 32)" << std::endl;
+            std::cout << "  --vad-model PATH           VAD模型文件 (默认为模型目录下的 silero_vad.onnx)" << std::endl;
+            std::cout << "  --listen ADDR              接收远程PCM音频，如 tcp://*:6680 或 ipc:///tmp/asr.ipc" << std::endl;
+            std::cout << "  --idle-seconds SEC         会话超过该时长未收到音频即结束 (默认 10)" << std::endl;
+            std::cout << "  --no-vad-gate              关闭各会话VAD前的能量门限" << std::endl;
+            std::cout << "  --vad-gate-margin DB       高于噪声基底多少dB即送入VAD (默认 9)" << std::endl;
+            std::cout << "  --bench N                  用 --wav 指定的音频模拟 N 路并发会话并输出统计" << std::endl;
+            std::cout << "  --wav PATH                 WAV文件或目录 (可重复)" << std::endl;
+            std::cout << "  --fast                     尽可能快地送入音频 (默认按实时节奏)" << std::endl;
+            std::cout << "  --help, -h                 显示此帮助信息" << std::endl;
+            return 0;
+        }
+    }
+    if (ingest.vad_model_path.empty()) {
+        ingest.vad_model_path = options.model_dir + "/silero_vad.onnx";
+    }
+
+    if (listen_mode) {
+        signal(SIGINT, signal_handler);
+        signal(SIGTERM, signal_handler);
+        PcmIngestServer server(options, ingest, [](const std::string& session, const std::string& text) {
+            std::cout << "[" << session << "] " << text << std::endl;
+        });
+        server.run(g_running);
+        server.print_stats();
+        return 0;
+    }
+
+    if (bench_sessions <= 0) {
+        std::cerr << "请使用 --listen ADDR 或 --bench N (见 --help)" << std::endl;
+        return -1;
+    }
+
+    AsrBatchServer server(options, [](AsrBatchServer::SessionId, const std::string& name,
+                                      const std::string& text) {
+        std::cout << "[" << name << "] " << text << std::endl;
+    });
+    return run_bench(server, wav_paths, bench_sessions, fast);
+}
@@ -0,0 +1,256 @@
+// asr_tuning.cpp
+// 识别器自动调优：测速与配置文件读写
+
+#include "asr_tuning.h"
+#include "latency_stats.h"
+#include "sys_util.h"
+#include "wav_file_source.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <unistd.h>
+
+using namespace sherpa_onnx::cxx;
+
+namespace {
+
+std::string host_name() {
+    char name[256] = {0};
+    if (gethostname(name, sizeof(name) - 1) != 0) {
+        return "localhost";
+    }
+    return name;
+}
+
+unsigned cpu_count() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::vector<int> thread_candidates() {
+    const int cpus = static_cast<int>(cpu_count());
+    std::vector<int> result;
+    for (int n = 1; n < cpus; n *= 2) {
+        result.push_back(n);
+    }
+    result.push_back(cpus);
+    return result;
+}
+
+double ms_since(std::chrono::steady_clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// 测一个配置：先用第一段音频预热，再按 100ms 一块流式送入所有音频；每段音频之前检查 running
+bool benchmark(const std::string& model_dir, ModelPrecision precision, int num_threads,
+               const std::vector<std::vector<float>>& clips, int sample_rate, const std::atomic<bool>& running,
+               AsrTuning& result) {
+    OnlineRecognizerConfig config = make_online_recognizer_config(model_dir, num_threads, precision);
+    auto t0 = std::chrono::steady_clock::now();
+    OnlineRecognizer recognizer = OnlineRecognizer::Create(config);
+    if (!recognizer.Get()) {
+        return false;
+    }
+    result.precision = precision;
+    result.num_threads = num_threads;
+    result.load_ms = ms_since(t0);
+
+    {
+        const auto& first = clips.front();
+        OnlineStream stream = recognizer.CreateStream();
+        stream.AcceptWaveform(sample_rate, first.data(),
+                              static_cast<int32_t>(std::min<size_t>(first.size(), sample_rate)));
+        stream.InputFinished();
+        while (recognizer.IsReady(&stream)) {
+            recognizer.Decode(&stream);
+        }
+    }
+
+    const size_t chunk = static_cast<size_t>(sample_rate / 10);
+    LatencyStats chunk_latency("chunk");
+    LatencyStats final_latency("final");
+    double decode_ms = 0.0;
+    size_t audio_samples = 0;
+    for (const auto& clip : clips) {
+        if (!running) {
+            return false;
+        }
+        OnlineStream stream = recognizer.CreateStream();
+        for (size_t offset = 0; offset < clip.size(); offset += chunk) {
+            size_t n = std::min(chunk, clip.size() - offset);
+            stream.AcceptWaveform(sample_rate, clip.data() + offset, static_cast<int32_t>(n));
+            t0 = std::chrono::steady_clock::now();
+            while (recognizer.IsReady(&stream)) {
+                recognizer.Decode(&stream);
+            }
+            double ms = ms_since(t0);
+            chunk_latency.add(ms);
+            decode_ms += ms;
+        }
+        stream.InputFinished();
+        t0 = std::chrono::steady_clock::now();
+        while (recognizer.IsReady(&stream)) {
+            recognizer.Decode(&stream);
+        }
+        recognizer.GetResult(&stream);
+        double ms = ms_since(t0);
+        final_latency.add(ms);
+        decode_ms += ms;
+        audio_samples += clip.size();
+    }
+
+    result.rtf = decode_ms / 1000.0 / (static_cast<double>(audio_samples) / sample_rate);
+    result.chunk_p50_ms = chunk_latency.percentile(50);
+    result.chunk_p90_ms = chunk_latency.percentile(90);
+    result.final_ms = final_latency.mean();
+    return true;
+}
+
+} // namespace
+
+std::string default_tuning_path() {
+    return cache_dir() + "/asr_tuning-" + host_name() + ".conf";
+}
+
+bool load_asr_tuning(const std::string& path, const std::string& model_dir, AsrTuning& tuning) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::map<std::string, std::string> values;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq != std::string::npos) {
+            values[line.substr(0, eq)] = line.substr(eq + 1);
+        }
+    }
+
+    if (values["host"] != host_name() || values["cpus"] != std::to_string(cpu_count()) ||
+        values["model_dir"] != model_dir) {
+        std::cout << "[Tuning] " << path << " 不是本机/当前模型的调优结果，忽略 (可用 --calibrate 重新校准)"
+                  << std::endl;
+        return false;
+    }
+    AsrTuning loaded;
+    try {
+        if (!parse_precision(values["precision"], loaded.precision)) {
+            return false;
+        }
+        loaded.num_threads = std::stoi(values["num_threads"]);
+        loaded.rtf = std::stod(values["rtf"]);
+        loaded.chunk_p90_ms = std::stod(values["chunk_p90_ms"]);
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (loaded.num_threads <= 0) {
+        return false;
+    }
+    tuning = loaded;
+    return true;
+}
+
+bool save_asr_tuning(const std::string& path, const std::string& model_dir, const AsrTuning& tuning) {
+    size_t slash = path.rfind('/');
+    if (slash != std::string::npos && slash > 0 && !make_dirs(path.substr(0, slash))) {
+        return false;
+    }
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file << "# 识别器自动调优结果，由 --calibrate 生成\n"
+         << "host=" << host_name() << "\n"
+         << "cpus=" << cpu_count() << "\n"
+         << "model_dir=" << model_dir << "\n"
+         << "precision=" << precision_name(tuning.precision) << "\n"
+         << "num_threads=" << tuning.num_threads << "\n"
+         << "rtf=" << tuning.rtf << "\n"
+         << "chunk_p90_ms=" << tuning.chunk_p90_ms << "\n";
+    return static_cast<bool>(file);
+}
+
+bool calibrate_asr(const std::string& model_dir, const std::vector<std::string>& wav_paths,
+                   float max_audio_seconds, const std::atomic<bool>& running, AsrTuning& best,
+                   std::ostream& os) {
+    const int sample_rate = 16000;
+    std::vector<std::vector<float>> clips;
+    size_t budget = static_cast<size_t>(max_audio_seconds * sample_rate);
+    for (const auto& path : WavFileSource::expand_paths(wav_paths)) {
+        if (budget == 0) {
+            break;
+        }
+        try {
+            MappedWav wav(path);
+            if (wav.sample_rate() != sample_rate) {
+                continue;
+            }
+            std::vector<float> clip(std::min(wav.num_samples(), budget));
+            wav.to_float(0, clip.size(), clip.data());
+            budget -= clip.size();
+            clips.push_back(std::move(clip));
+        } catch (const std::exception& e) {
+            os << "[Calibrate] 跳过 " << path << ": " << e.what() << std::endl;
+        }
+    }
+    if (clips.empty()) {
+        os << "[Calibrate] 错误：没有可用的 16kHz 测试音频" << std::endl;
+        return false;
+    }
+    auto precisions = available_precisions(model_dir);
+    if (precisions.empty()) {
+        os << "[Calibrate] 错误：模型目录中没有识别模型: " << model_dir << std::endl;
+        return false;
+    }
+
+    double audio_seconds = 0.0;
+    for (const auto& clip : clips) {
+        audio_seconds += static_cast<double>(clip.size()) / sample_rate;
+    }
+    os << "[Calibrate] 本机 " << host_name() << "，" << cpu_count() << " 个CPU，测试音频 " << clips.size()
+       << " 段共 " << audio_seconds << " 秒" << std::endl;
+
+    std::vector<AsrTuning> results;
+    for (ModelPrecision precision : precisions) {
+        for (int threads : thread_candidates()) {
+            if (!running) {
+                os << "[Calibrate] 已中断，未保存结果" << std::endl;
+                return false;
+            }
+            AsrTuning result;
+            if (!benchmark(model_dir, precision, threads, clips, sample_rate, running, result)) {
+                if (!running) {
+                    continue;
+                }
+                os << "[Calibrate] " << precision_name(precision) << " " << threads << " 线程: 创建识别器失败"
+                   << std::endl;
+                continue;
+            }
+            os << "[Calibrate] " << precision_name(precision) << " " << threads << " 线程: 加载 "
+               << result.load_ms << " ms，RTF " << result.rtf << "，每块解码 p50 " << result.chunk_p50_ms
+               << " ms / p90 " << result.chunk_p90_ms << " ms，尾部冲刷 " << result.final_ms << " ms"
+               << std::endl;
+            results.push_back(result);
+        }
+    }
+    if (results.empty()) {
+        return false;
+    }
+
+    // RTF 最低者为基准；相差 5% 以内时选线程更少的配置，把 CPU 留给 VAD、TTS 等其它组件
+    auto fastest = std::min_element(results.begin(), results.end(),
+                                    [](const AsrTuning& a, const AsrTuning& b) { return a.rtf < b.rtf; });
+    best = *fastest;
+    for (const auto& result : results) {
+        if (result.rtf <= fastest->rtf * 1.05 && result.num_threads < best.num_threads) {
+            best = result;
+        }
+    }
+    os << "[Calibrate] 最佳配置: " << precision_name(best.precision) << "，" << best.num_threads
+       << " 线程 (RTF " << best.rtf << "，每块解码 p90 " << best.chunk_p90_ms << " ms)" << std::endl;
+    return true;
+}
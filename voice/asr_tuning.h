@@ -0,0 +1,36 @@
+// asr_tuning.h
+// 识别器自动调优：在本机上用测试音频对各模型精度 (int8/fp32) 与推理线程数组合逐一测速，
+// 选出最快的配置写入按主机名区分的配置文件，之后启动时自动读取。
+#ifndef ASR_TUNING_H
+#define ASR_TUNING_H
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "asr_model.h"
+
+struct AsrTuning {
+    ModelPrecision precision = ModelPrecision::Auto;
+    int num_threads = 4;
+    double load_ms = 0.0;           // 创建识别器耗时
+    double rtf = 0.0;               // 解码耗时 / 音频时长
+    double chunk_p50_ms = 0.0;      // 每送入 100ms 音频后解码的耗时
+    double chunk_p90_ms = 0.0;
+    double final_ms = 0.0;          // 输入结束后冲刷尾部的平均耗时 (即端点处的等待)
+};
+
+// 默认配置文件路径: ~/.cache/voice_assistant/asr_tuning-<主机名>.conf
+std::string default_tuning_path();
+
+// 读取调优结果；主机名、CPU数或模型目录与本机不符时视为过期，返回 false
+bool load_asr_tuning(const std::string& path, const std::string& model_dir, AsrTuning& tuning);
+bool save_asr_tuning(const std::string& path, const std::string& model_dir, const AsrTuning& tuning);
+
+// 对每个可用精度和线程数 (1, 2, 4, ... 直到 CPU 数) 测速，逐项打印并返回最佳配置。
+// 至多使用 max_audio_seconds 秒的音频；没有可用模型或音频、或 running 变为 false (用户中断) 时返回 false
+bool calibrate_asr(const std::string& model_dir, const std::vector<std::string>& wav_paths,
+                   float max_audio_seconds, const std::atomic<bool>& running, AsrTuning& best,
+                   std::ostream& os = std::cout);
+
+#endif // ASR_TUNING_H
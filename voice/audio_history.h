@@ -0,0 +1,66 @@
+// audio_history.h
+// 固定容量的音频历史缓冲区：始终保留最近写入的 N 个采样，旧数据被覆盖。
+// 用于语音起始前的预录 (pre-roll)，避免 VAD 判定延迟导致开头被截断。
+// 非线程安全，只在处理线程中使用。
+#ifndef AUDIO_HISTORY_H
+#define AUDIO_HISTORY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+class AudioHistory {
+public:
+    explicit AudioHistory(size_t capacity = 0) : buffer_(capacity) {}
+
+    void reset(size_t capacity) {
+        buffer_.assign(capacity, 0.0f);
+        write_pos_ = 0;
+        size_ = 0;
+    }
+
+    void append(const float* samples, size_t n) {
+        const size_t capacity = buffer_.size();
+        if (capacity == 0) {
+            return;
+        }
+        if (n >= capacity) {
+            samples += n - capacity;
+            n = capacity;
+        }
+        const size_t first = std::min(n, capacity - write_pos_);
+        std::copy(samples, samples + first, buffer_.begin() + write_pos_);
+        std::copy(samples + first, samples + n, buffer_.begin());
+        write_pos_ = (write_pos_ + n) % capacity;
+        size_ = std::min(size_ + n, capacity);
+    }
+
+    // 按时间顺序取出最近的 min(n, size()) 个采样，写入 out (覆盖原内容)
+    void latest(size_t n, std::vector<float>& out) const {
+        const size_t capacity = buffer_.size();
+        n = std::min(n, size_);
+        out.resize(n);
+        if (n == 0) {
+            return;
+        }
+        const size_t start = (write_pos_ + capacity - n) % capacity;
+        const size_t first = std::min(n, capacity - start);
+        std::copy(buffer_.begin() + start, buffer_.begin() + start + first, out.begin());
+        std::copy(buffer_.begin(), buffer_.begin() + (n - first), out.begin() + first);
+    }
+
+    void clear() {
+        write_pos_ = 0;
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return buffer_.size(); }
+
+private:
+    std::vector<float> buffer_;
+    size_t write_pos_ = 0;
+    size_t size_ = 0;
+};
+
+#endif // AUDIO_HISTORY_H
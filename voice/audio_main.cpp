@@ -1,11 +1,25 @@
 #include "globals.h"       // 包含我们创建的全局变量头文件
 #include "audio_monitor.h" // 包含AudioMonitor的头文件
-#include "ZmqClient.h"     // 您的ZMQ客户端头文件
+#include "control_message.h"
+#include "echo_reference.h"
+#include "asr_tuning.h"
+#include "event_reactor.h"
+#include "latency_stats.h"
+#include "utterance_dispatcher.h"
+#include "wav_file_source.h"
+#include "ZmqContext.h"
+#include "ZmqPublisher.h"
+#include "ZmqReliableClient.h"
+#include "ZmqStreamClient.h"
+#include "ZmqSubscriber.h"
+#include <chrono>
 #include <iostream>
 #include <functional>
 #include <thread>
 #include <signal.h>
+#include <unistd.h>
 #include <memory>
+#include <vector>
 #include <zmq.hpp> // 确保包含了zmq.hpp
 
 // --- 全局变量定义 ---
@@ -13,8 +27,17 @@
 std::atomic<bool> g_running(true);
 std::atomic<bool> g_is_tts_speaking(false);
 
-// 定义ZMQ客户端指针
-std::unique_ptr<zmq_component::ZmqClient> g_zmq_client;
+// 定义ZMQ客户端指针 (超时后自动重建连接并重试)
+std::unique_ptr<zmq_component::ZmqReliableClient> g_zmq_client;
+// --llm-stream：服务端分块回复，边收边打印；为空时使用上面的可靠客户端
+std::unique_ptr<zmq_component::ZmqStreamClient> g_llm_stream_client;
+LatencyStats g_llm_first_chunk{"LLM请求→首个回复块"};
+// 离线评测时只打印识别结果，不请求LLM
+bool g_no_llm = false;
+// 识别结果分发队列，由独立线程向LLM发送请求
+std::unique_ptr<UtteranceDispatcher> g_dispatcher;
+// 每次用户打断播放时递增，正在接收的LLM回复发现变化即停止接收
+std::atomic<uint64_t> g_cancel_epoch(0);
 
 
 // --- 函数实现 ---
@@ -27,39 +50,75 @@ void signal_handler(int signal) {
     }
 }
 
-// 线程函数：专门用于监听TTS服务的状态更新
-void tts_status_listener() {
-    zmq::context_t context(1);
-    zmq::socket_t subscriber(context, zmq::socket_type::sub);
-    subscriber.connect("tcp://localhost:6677");
-    subscriber.set(zmq::sockopt::subscribe, "STATUS::");
-
-    std::cout << "[Status] 状态监听线程已启动，正在监听 TTS 状态..." << std::endl;
-
-    while (g_running) {
-        zmq::message_t topic;
-        if (subscriber.recv(topic, zmq::recv_flags::dontwait)) {
-            std::string status = topic.to_string();
-            if (status == "STATUS::SPEAKING") {
-                g_is_tts_speaking = true;
-                std::cout << "[Status] TTS正在讲话，暂停识别..." << std::endl;
-            } else if (status == "STATUS::IDLE") {
-                g_is_tts_speaking = false;
-                std::cout << "[Status] TTS已结束，恢复识别。" << std::endl;
+// 处理TTS服务发布的状态 (在事件循环中收到消息后立即调用)
+void apply_tts_status(const std::string& status) {
+    if (status == "STATUS::SPEAKING") {
+        g_is_tts_speaking = true;
+        std::cout << "[Status] TTS正在讲话，暂停识别..." << std::endl;
+    } else if (status == "STATUS::IDLE") {
+        g_is_tts_speaking = false;
+        std::cout << "[Status] TTS已结束，恢复识别。" << std::endl;
+    }
+}
+
+// 分发线程：把一句完整文本发送给LLM并等待确认 (可能耗时数秒，不在采集线程中执行)
+// 流式接收LLM回复：每个数据块到达即输出，不必等整段回答生成完毕。
+// start 为首块延迟的起点 (推测命中时为最终文本到达的时刻)
+void send_to_llm_streaming(const std::string& text, std::chrono::steady_clock::time_point start) {
+    try {
+        std::cout << "[ZMQ] 正在发送给Windows LLM服务 (流式)..." << std::endl;
+        const uint64_t epoch = g_cancel_epoch;
+        bool first = true;
+        std::cout << "\n🤖 LLM: " << std::flush;
+        g_llm_stream_client->request(text, [&](std::string_view chunk) {
+            if (g_cancel_epoch != epoch) {
+                std::cout << "\n[BargeIn] 回复已被打断，停止接收" << std::endl;
+                return false;
             }
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            if (first) {
+                first = false;
+                g_llm_first_chunk.add(std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count());
+            }
+            std::cout << chunk << std::flush;
+            return g_running.load();
+        });
+        std::cout << "\n" << std::endl;
+    } catch (const zmq_component::ZmqCommunicationError& e) {
+        std::cerr << "\n[ZMQ] 通信错误: " << e.what() << std::endl;
+    }
+}
+
+// 推测请求：中间结果稳定时提前发出，LLM 的预填充和解码与端点等待重叠。
+// 服务端只生成、不送TTS播放 (协议见 control_message.h)：命中时再发送最终文本，服务端直接播放已生成的回答；
+// 未命中或被取代时已发布 CONTROL::DISCARD，这里读到服务端的回复 (已停止生成) 才返回，之后的请求不会排在它后面
+bool send_to_llm_speculative(const std::string& text, const Speculation& speculation) {
+    bool replied = false;
+    // 发出前就已命中：不必再推测，直接发送最终文本
+    if (speculation.state() != Speculation::State::Committed) {
+        try {
+            std::cout << "[Speculate] 中间结果已稳定，提前发送: " << text << std::endl;
+            g_llm_stream_client->request(make_speculative_request(speculation.id(), text),
+                                         [](std::string_view) { return true; });
+            replied = true;
+        } catch (const zmq_component::ZmqCommunicationError& e) {
+            std::cerr << "\n[ZMQ] 通信错误: " << e.what() << std::endl;
         }
     }
-    std::cout << "[Status] 状态监听线程已退出。" << std::endl;
+    // 回答已生成而最终文本还没出来：等待确认
+    if (speculation.wait() == Speculation::State::Committed) {
+        send_to_llm_streaming(text, speculation.resolved_at());
+    } else if (replied) {
+        std::cout << "[Speculate] 推测请求已取消，服务端已停止 (最终文本不同、被取代或被打断)" << std::endl;
+    }
+    return replied;
 }
 
-// 回调函数：当ASR识别出完整一句话后，此函数被调用
-void on_speech_recognized(const std::string& text) {
-    if (text.empty()) {
+void send_to_llm(const std::string& text) {
+    if (g_llm_stream_client) {
+        send_to_llm_streaming(text, std::chrono::steady_clock::now());
         return;
     }
-    std::cout << "\n[ASR] 识别到最终文本: " << text << std::endl;
     if (!g_zmq_client) {
         std::cerr << "[错误] ZMQ客户端未初始化！" << std::endl;
         return;
@@ -73,31 +132,417 @@ void on_speech_recognized(const std::string& text) {
     }
 }
 
+void print_llm_stats() {
+    if (g_llm_stream_client) {
+        g_llm_first_chunk.print();
+        return;
+    }
+    if (!g_zmq_client) {
+        return;
+    }
+    const auto& stats = g_zmq_client->stats();
+    std::cout << "[ZMQ] 请求 " << stats.requests << " 次，成功 " << stats.successes
+              << "，失败 " << stats.failures << "，重试 " << stats.retries
+              << "，重建连接 " << stats.reconnects << "，丢弃迟到回复 " << stats.late_replies_dropped
+              << "，平均延迟 " << stats.averageLatencyMs() << " ms，最大 " << stats.max_latency_ms
+              << " ms" << std::endl;
+}
+
+// 回调函数：当ASR识别出完整一句话后，此函数被调用 (运行在采集/识别线程中，只负责入队)
+void on_speech_recognized(const std::string& text) {
+    if (text.empty()) {
+        return;
+    }
+    std::cout << "\n[ASR] 识别到最终文本: " << text << std::endl;
+    if (g_no_llm || !g_dispatcher) {
+        return;
+    }
+    g_dispatcher->submit(text);
+}
+
 // --- 主函数 ---
 int main(int argc, char* argv[]) {
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
-    
     std::string server_address = "tcp://192.168.118.1:6666";
     int device_idx = -1; 
+    MonitorOptions options;
+    std::string model_dir = "./models/sherpa-onnx-streaming-zipformer-small-bilingual-zh-en-2023-02-16";
+    bool calibrate = false;
+    std::vector<std::string> wav_paths;
+    bool wav_fast = false;
+    bool wav_loop = false;
+    int zmq_io_threads = 1;
+    size_t queue_size = 4;
+    QueueFullPolicy queue_policy = QueueFullPolicy::Coalesce;
+    bool llm_stream = false;
+    std::string partial_pub_address;
+    std::string control_pub_address = "tcp://*:6690";
+    std::string session_id;
+    std::string aec_ref_address = "tcp://localhost:6677";
+    zmq_component::RetryPolicy retry_policy;
+    retry_policy.timeout_ms = 15000;
+    // LLM 请求不是幂等的：服务端生成完整回答并送TTS播放后才回复，超时重发会让同一个回答再生成、再播放一遍
+    retry_policy.max_retries = 0;
+    retry_policy.backoff_initial_ms = 100;
+    retry_policy.backoff_max_ms = 2000;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--device" && i + 1 < argc) {
+            device_idx = std::stoi(argv[++i]);
+        } else if (arg == "--model-dir" && i + 1 < argc) {
+            model_dir = argv[++i];
+        } else if (arg == "--asr-threads" && i + 1 < argc) {
+            options.asr_threads = std::stoi(argv[++i]);
+        } else if (arg == "--tuning-file" && i + 1 < argc) {
+            options.tuning_file = argv[++i];
+        } else if (arg == "--calibrate") {
+            calibrate = true;
+        } else if (arg == "--capture-mode" && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode == "callback") {
+                options.capture_mode = CaptureMode::Callback;
+            } else if (mode == "blocking") {
+                options.capture_mode = CaptureMode::Blocking;
+            } else {
+                std::cerr << "未知的采集模式: " << mode << std::endl;
+                return -1;
+            }
+        } else if (arg == "--ring-seconds" && i + 1 < argc) {
+            options.ring_buffer_seconds = std::stof(argv[++i]);
+        } else if (arg == "--streaming-asr") {
+            options.streaming_asr = true;
+        } else if (arg == "--adaptive-endpoint") {
+            options.endpoint.enabled = true;
+            options.streaming_asr = true;
+        } else if (arg == "--endpoint-min-silence" && i + 1 < argc) {
+            options.endpoint.min_silence_ms = std::stof(argv[++i]);
+        } else if (arg == "--endpoint-max-silence" && i + 1 < argc) {
+            options.endpoint.max_silence_ms = std::stof(argv[++i]);
+        } else if (arg == "--speculate-frames" && i + 1 < argc) {
+            options.stable_frames = std::stoi(argv[++i]);
+            options.streaming_asr = true;
+        } else if (arg == "--barge-in") {
+            options.barge_in = true;
+        } else if (arg == "--barge-in-ms" && i + 1 < argc) {
+            options.barge_in_ms = std::stof(argv[++i]);
+        } else if (arg == "--barge-in-margin" && i + 1 < argc) {
+            options.barge_in_margin_db = std::stof(argv[++i]);
+        } else if (arg == "--aec") {
+            // 消除回声后播放期间也能可靠地听到用户，默认开启插话
+            options.aec.enabled = true;
+            options.barge_in = true;
+        } else if (arg == "--aec-ref" && i + 1 < argc) {
+            aec_ref_address = argv[++i];
+        } else if (arg == "--aec-delay" && i + 1 < argc) {
+            options.aec.delay_ms = std::stof(argv[++i]);
+        } else if (arg == "--aec-filter-ms" && i + 1 < argc) {
+            options.aec.filter_ms = std::stof(argv[++i]);
+        } else if (arg == "--control-pub" && i + 1 < argc) {
+            control_pub_address = argv[++i];
+        } else if (arg == "--session" && i + 1 < argc) {
+            session_id = argv[++i];
+        } else if (arg == "--partial-pub" && i + 1 < argc) {
+            partial_pub_address = argv[++i];
+        } else if (arg == "--preroll" && i + 1 < argc) {
+            options.preroll_seconds = std::stof(argv[++i]);
+        } else if (arg == "--no-prefetch") {
+            options.prefetch_models = false;
+        } else if (arg == "--no-warmup") {
+            options.warmup = false;
+        } else if (arg == "--warmup-wav" && i + 1 < argc) {
+            options.warmup_wav = argv[++i];
+        } else if (arg == "--stream-pool" && i + 1 < argc) {
+            options.stream_pool_size = std::stoul(argv[++i]);
+        } else if (arg == "--kws-model-dir" && i + 1 < argc) {
+            options.kws_model_dir = argv[++i];
+        } else if (arg == "--keywords-file" && i + 1 < argc) {
+            options.keywords_file = argv[++i];
+        } else if (arg == "--wake-window" && i + 1 < argc) {
+            options.wake_window_seconds = std::stof(argv[++i]);
+        } else if (arg == "--no-vad-gate") {
+            options.vad_gate.enabled = false;
+        } else if (arg == "--vad-gate-margin" && i + 1 < argc) {
+            options.vad_gate.margin_db = std::stof(argv[++i]);
+        } else if (arg == "--wav" && i + 1 < argc) {
+            wav_paths.push_back(argv[++i]);
+        } else if (arg == "--fast") {
+            wav_fast = true;
+        } else if (arg == "--loop") {
+            wav_loop = true;
+        } else if (arg == "--queue-size" && i + 1 < argc) {
+            queue_size = std::stoul(argv[++i]);
+        } else if (arg == "--queue-policy" && i + 1 < argc) {
+            std::string policy = argv[++i];
+            if (!UtteranceDispatcher::parse_policy(policy, queue_policy)) {
+                std::cerr << "未知的队列策略: " << policy << std::endl;
+                return -1;
+            }
+        } else if (arg == "--zmq-io-threads" && i + 1 < argc) {
+            zmq_io_threads = std::stoi(argv[++i]);
+        } else if (arg == "--llm-timeout" && i + 1 < argc) {
+            retry_policy.timeout_ms = std::stoi(argv[++i]);
+        } else if (arg == "--llm-retries" && i + 1 < argc) {
+            retry_policy.max_retries = std::stoi(argv[++i]);
+        } else if (arg == "--llm-stream") {
+            llm_stream = true;
+        } else if (arg == "--no-llm") {
+            g_no_llm = true;
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "用法: " << argv[0] << " [选项]" << std::endl;
+            std::cout << "选项:" << std::endl;
+            std::cout << "  --device INDEX             音频设备索引" << std::endl;
+            std::cout << "  --model-dir DIR            流式识别模型目录" << std::endl;
+            std::cout << "  --calibrate                对各模型精度与线程数测速，把最快的配置保存为本机默认值后退出" << std::endl;
+            std::cout << "  --asr-threads N            识别器推理线程数 (默认读取 --calibrate 的结果，没有时为 4)" << std::endl;
+            std::cout << "  --tuning-file PATH         校准结果文件 (默认 ~/.cache/voice_assistant/asr_tuning-<主机名>.conf)" << std::endl;
+            std::cout << "  --capture-mode MODE        采集模式: blocking (默认) 或 callback" << std::endl;
+            std::cout << "  --ring-seconds SEC         回调模式环形缓冲区时长 (默认 2.0)" << std::endl;
+            std::cout << "  --streaming-asr            语音期间边说边解码，端点触发时即可得到最终结果" << std::endl;
+            std::cout << "  --adaptive-endpoint        自适应端点 (隐含 --streaming-asr)：短句静音约 200ms 即结束" << std::endl;
+            std::cout << "  --endpoint-min-silence MS  短句结束所需的最短尾部静音 (默认 150)" << std::endl;
+            std::cout << "  --endpoint-max-silence MS  长句/句中停顿允许的最长静音，即 VAD 静音时长 (默认 1000)" << std::endl;
+            std::cout << "  --barge-in                 TTS播放期间检测插话，打断时发布 CONTROL::CANCEL 并识别这句话" << std::endl;
+            std::cout << "  --barge-in-ms MS           插话需持续的语音时长 (默认 300)" << std::endl;
+            std::cout << "  --barge-in-margin DB       插话能量需高出噪声基底多少dB，用于排除回声 (默认 15)" << std::endl;
+            std::cout << "  --aec                      以TTS播放的PCM为参考消除回声 (隐含 --barge-in)" << std::endl;
+            std::cout << "  --aec-ref ADDR             TTS::PCM 参考信号的订阅地址 (默认 tcp://localhost:6677)" << std::endl;
+            std::cout << "  --aec-delay MS             参考信号的固定延迟 (默认 0)" << std::endl;
+            std::cout << "  --aec-filter-ms MS         回声消除滤波器覆盖的回声路径长度 (默认 128)" << std::endl;
+            std::cout << "  --control-pub ADDR         控制消息发布地址 (默认 tcp://*:6690)" << std::endl;
+            std::cout << "  --session ID               控制消息中的会话ID (默认主机名)" << std::endl;
+            std::cout << "  --partial-pub ADDR         在该地址 (如 tcp://*:6688) 以PUB发布中间/最终识别结果" << std::endl;
+            std::cout << "  --preroll SEC              流式识别的语音起始预录时长 (默认 0.5)" << std::endl;
+            std::cout << "  --no-prefetch              创建模型会话前不预读模型文件" << std::endl;
+            std::cout << "  --no-warmup                启动时不预热模型" << std::endl;
+            std::cout << "  --warmup-wav PATH          预热用的WAV文件 (默认使用合成的类语音信号)" << std::endl;
+            std::cout << "  --stream-pool N            后台预先创建的识别流数量，0 为每句结束时同步创建 (默认 2)" << std::endl;
+            std::cout << "  --kws-model-dir DIR        唤醒模式：只有检测到唤醒词后才运行完整识别器" << std::endl;
+            std::cout << "  --keywords-file PATH       唤醒词文件 (默认为KWS模型目录下的 keywords.txt)" << std::endl;
+            std::cout << "  --wake-window SEC          唤醒后多久没有新的语音即回到休眠 (默认 8)" << std::endl;
+            std::cout << "  --no-vad-gate              关闭VAD前的能量门限，每帧都做VAD推理" << std::endl;
+            std::cout << "  --vad-gate-margin DB       高于噪声基底多少dB即送入VAD (默认 9)" << std::endl;
+            std::cout << "  --wav PATH                 使用WAV文件或目录代替麦克风 (可重复)" << std::endl;
+            std::cout << "  --fast                     WAV尽可能快地回放 (默认按实时节奏)" << std::endl;
+            std::cout << "  --loop                     WAV循环回放，用于浸泡测试" << std::endl;
+            std::cout << "  --queue-size N             待发送给LLM的最大句子数 (默认 4)" << std::endl;
+            std::cout << "  --queue-policy POLICY      队列满时的策略: coalesce (默认)、drop-oldest 或 block" << std::endl;
+            std::cout << "  --zmq-io-threads N         共享ZMQ上下文的I/O线程数 (默认 1)" << std::endl;
+            std::cout << "  --llm-timeout MS           每次等待LLM回复的超时 (默认 15000)" << std::endl;
+            std::cout << "  --llm-retries N            超时后重建连接并重试的次数 (默认 0，服务端会重复生成并播放，仅在其能去重时开启)" << std::endl;
+            std::cout << "  --llm-stream               流式接收LLM回复 (服务端分块发送时边收边输出)" << std::endl;
+            std::cout << "  --speculate-frames N       中间结果连续N帧 (每帧100ms) 未变化即提前发送给LLM (需 --llm-stream)" << std::endl;
+            std::cout << "  --no-llm                   只打印识别结果，不发送给LLM" << std::endl;
+            std::cout << "  --help, -h                 显示此帮助信息" << std::endl;
+            return 0;
+        }
+    }
+
+    if (calibrate) {
+        // 默认使用模型目录自带的测试音频
+        std::string resolved_dir = AudioMonitor::resolve_model_dir(model_dir);
+        if (wav_paths.empty()) {
+            wav_paths.push_back(resolved_dir + "/test_wavs");
+        }
+        // 校准不进入事件循环，用普通信号处理函数，每测完一段音频检查一次 g_running
+        signal(SIGINT, signal_handler);
+        signal(SIGTERM, signal_handler);
+        AsrTuning best;
+        if (!calibrate_asr(resolved_dir, wav_paths, 30.0f, g_running, best)) {
+            return -1;
+        }
+        std::string path = options.tuning_file.empty() ? default_tuning_path() : options.tuning_file;
+        if (!save_asr_tuning(path, resolved_dir, best)) {
+            std::cerr << "错误：无法写入 " << path << std::endl;
+            return -1;
+        }
+        std::cout << "已保存到 " << path << "，之后启动时自动使用" << std::endl;
+        return 0;
+    }
+
+    // 信号、TTS状态和采集就绪通知都由主线程的事件循环处理。
+    // 必须在创建任何线程 (ZMQ I/O、ASR、PortAudio) 之前屏蔽信号，改由 signalfd 接收
+    EventReactor reactor;
+    if (!reactor.add_signals({SIGINT, SIGTERM}, [&reactor](int signo) {
+            signal_handler(signo);
+            reactor.stop();
+        })) {
+        signal(SIGINT, signal_handler);
+        signal(SIGTERM, signal_handler);
+    }
 
+    if (options.stable_frames > 0 && (!llm_stream || g_no_llm)) {
+        // 推测请求和命中后的确认请求都经流式客户端发送
+        std::cerr << "警告：--speculate-frames 需要 --llm-stream，已关闭推测发送" << std::endl;
+        options.stable_frames = 0;
+    }
+
+    zmq_component::ZmqContext::setIoThreads(zmq_io_threads);
     try {
-        g_zmq_client = std::make_unique<zmq_component::ZmqClient>(server_address);
-        g_zmq_client->setTimeout(15000); 
+        if (llm_stream) {
+            g_llm_stream_client = std::make_unique<zmq_component::ZmqStreamClient>(server_address);
+            g_llm_stream_client->setTimeout(retry_policy.timeout_ms);
+        } else {
+            g_zmq_client = std::make_unique<zmq_component::ZmqReliableClient>(server_address, retry_policy);
+        }
     } catch(const std::exception& e) {
         std::cerr << "初始化ZMQ客户端失败: " << e.what() << std::endl;
         return -1;
     }
     
-    AudioMonitor monitor("./models/sherpa-onnx-streaming-zipformer-small-bilingual-zh-en-2023-02-16");
+    AudioMonitor monitor(model_dir, "", options);
+
+    // 控制消息：插话时通知 LLM/TTS 服务停止生成与播放，推测请求未命中时通知 LLM 服务停止生成
+    std::unique_ptr<zmq_component::ZmqPublisher> control_publisher;
+    if (options.barge_in || options.stable_frames > 0) {
+        if (session_id.empty()) {
+            char host[256] = {0};
+            session_id = gethostname(host, sizeof(host) - 1) == 0 ? host : "voice";
+        }
+        try {
+            control_publisher = std::make_unique<zmq_component::ZmqPublisher>(control_pub_address);
+        } catch (const zmq_component::ZmqCommunicationError& e) {
+            std::cerr << "初始化控制消息发布端失败: " << e.what() << std::endl;
+            return -1;
+        }
+        std::cout << "[Control] 控制消息发布于 " << control_pub_address << "，会话 " << session_id << std::endl;
+    }
+    // 插话：发布取消消息，本地同时中止正在接收的回复和排队的句子
+    if (options.barge_in) {
+        monitor.set_barge_in_callback([&](uint64_t utterance_id) {
+            ++g_cancel_epoch;
+            g_is_tts_speaking = false;
+            size_t dropped = g_dispatcher ? g_dispatcher->cancel_pending() : 0;
+            try {
+                control_publisher->publish(make_cancel_message(session_id, utterance_id));
+            } catch (const zmq_component::ZmqCommunicationError& e) {
+                std::cerr << "[BargeIn] 发布取消消息失败: " << e.what() << std::endl;
+            }
+            std::cout << "[BargeIn] 已发布取消 (句子 " << utterance_id << ")，丢弃排队的句子 " << dropped << " 句"
+                      << std::endl;
+        });
+    }
+
+    // 中间识别结果：每次变化即以差量发布，界面和下游服务无需轮询或解析日志
+    std::unique_ptr<zmq_component::ZmqPublisher> hypothesis_publisher;
+    HypothesisEncoder hypothesis_encoder;
+    if (!partial_pub_address.empty()) {
+        try {
+            hypothesis_publisher = std::make_unique<zmq_component::ZmqPublisher>(partial_pub_address);
+        } catch (const zmq_component::ZmqCommunicationError& e) {
+            std::cerr << "初始化识别结果发布端失败: " << e.what() << std::endl;
+            return -1;
+        }
+        std::cout << "[Partial] 识别结果发布于 " << partial_pub_address << "，主题 " << kHypothesisTopic << std::endl;
+        monitor.set_hypothesis_callback([&](const HypothesisUpdate& update) {
+            try {
+                hypothesis_publisher->publish(kHypothesisTopic, hypothesis_encoder.encode(update));
+            } catch (const zmq_component::ZmqCommunicationError& e) {
+                std::cerr << "[Partial] 发布失败: " << e.what() << std::endl;
+            }
+        });
+    }
     
     std::cout << "===== 语音助手已启动 (v3.0 Refactored) =====" << std::endl;
     
-    std::thread status_thread(tts_status_listener);
-    monitor.start_monitoring(device_idx, on_speech_recognized);
+    g_dispatcher = std::make_unique<UtteranceDispatcher>(queue_size, queue_policy, send_to_llm);
+    // 退出时中止正在等待的LLM请求，Ctrl+C 不必等到请求超时
+    g_dispatcher->set_interrupt_handler([] {
+        if (g_zmq_client) {
+            g_zmq_client->interrupt();
+        }
+        if (g_llm_stream_client) {
+            g_llm_stream_client->interrupt();
+        }
+    });
+    if (options.stable_frames > 0) {
+        g_dispatcher->set_speculative_handler(send_to_llm_speculative);
+        // 在处理线程的 submit()/speculate() 中调用，与插话回调同一线程，共用同一个 PUB 套接字
+        g_dispatcher->set_discard_handler([&](const Speculation& speculation) {
+            try {
+                control_publisher->publish(make_discard_message(session_id, speculation.id()));
+            } catch (const zmq_component::ZmqCommunicationError& e) {
+                std::cerr << "[Speculate] 发布丢弃消息失败: " << e.what() << std::endl;
+            }
+        });
+        monitor.set_stable_callback([](const std::string& text) {
+            g_dispatcher->speculate(text);
+        });
+    }
+    g_dispatcher->start();
+
+    // TTS状态：消息到达即更新，不再轮询
+    zmq_component::ZmqSubscriber status_subscriber("tcp://localhost:6677", "STATUS::");
+    reactor.add_socket(status_subscriber.socket(), [&status_subscriber] {
+        std::string status;
+        while (status_subscriber.tryReceive(status)) {
+            apply_tts_status(status);
+        }
+    });
+
+    // 回声消除的参考信号：TTS 播放的 PCM 到达即写入按时间排列的缓冲区，处理线程按采集时刻读取
+    std::unique_ptr<zmq_component::ZmqSubscriber> reference_subscriber;
+    if (options.aec.enabled) {
+        auto echo_reference = std::make_shared<EchoReference>(monitor.sample_rate());
+        reference_subscriber = std::make_unique<zmq_component::ZmqSubscriber>(aec_ref_address, kPcmTopic);
+        reactor.add_socket(reference_subscriber->socket(), [&reference_subscriber, echo_reference] {
+            std::string topic;
+            std::string payload;
+            while (reference_subscriber->tryReceive(topic, payload)) {
+                echo_reference->push_message(payload);
+            }
+        });
+        monitor.set_echo_reference(echo_reference);
+        std::cout << "[AEC] 参考信号订阅于 " << aec_ref_address << std::endl;
+    }
+
+    std::unique_ptr<AudioSource> source;
+    if (wav_paths.empty()) {
+        source = monitor.create_device_source(device_idx);
+    } else {
+        source = std::make_unique<WavFileSource>(wav_paths,
+                                                 wav_fast ? WavFileSource::Pacing::AsFastAsPossible
+                                                          : WavFileSource::Pacing::Realtime,
+                                                 wav_loop);
+    }
+    if (!monitor.begin(*source, on_speech_recognized)) {
+        g_dispatcher->stop();
+        return -1;
+    }
+
+    if (source->ready_fd() >= 0) {
+        // 回调采集：音频到达即在事件循环中处理，整个程序只有这一个等待点
+        reactor.add_fd(source->ready_fd(), [&monitor, &reactor] {
+            ReadStatus status;
+            while ((status = monitor.process_pending(0)) == ReadStatus::Ok) {
+            }
+            if (status == ReadStatus::Finished || status == ReadStatus::Error) {
+                reactor.stop();
+            }
+        });
+        reactor.run();
+    } else {
+        // 阻塞读取的音频源 (阻塞采集模式、WAV回放) 在单独线程中读取，事件循环照常处理状态和信号
+        std::thread capture_thread([&monitor, &reactor] {
+            while (g_running) {
+                ReadStatus status = monitor.process_pending(100);
+                if (status == ReadStatus::Finished || status == ReadStatus::Error) {
+                    break;
+                }
+            }
+            reactor.stop();
+        });
+        reactor.run();
+        g_running = false;
+        capture_thread.join();
+    }
+    g_running = false;
+    monitor.end();
 
-    std::cout << "主监控循环已退出，正在等待状态监听线程结束..." << std::endl;
-    status_thread.join();
+    std::cout << "主监控循环已退出。" << std::endl;
+    hypothesis_encoder.print_stats();
+    g_dispatcher->print_stats();
+    g_dispatcher->stop();
+    print_llm_stats();
     
     std::cout << "程序已完全退出。" << std::endl;
     return 0;
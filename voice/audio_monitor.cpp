@@ -9,53 +9,177 @@
 // audio_monitor.cpp (最终修正版)
 
 #include "audio_monitor.h"
+#include "asr_model.h"
+#include "asr_tuning.h"
 #include "globals.h"
+#include "sys_util.h"
+#include "wav_file_source.h"
+#include <algorithm>
 #include <iostream>
+#include <exception>
 #include <fstream>
 #include <thread>
 #include <chrono>
+#include <cmath>
+#include <random>
 #include <signal.h>
 
 // 使用 using namespace 来简化代码
 using namespace sherpa_onnx::cxx;
 
-AudioMonitor::AudioMonitor(const std::string& model_dir, const std::string& vad_model_path)
-    : model_dir_("/home/lx/桌面/Voice/LLM_Voice_Flow-master/voice/models/sherpa-onnx-streaming-zipformer-small-bilingual-zh-en-2023-02-16"),
+namespace {
+
+// 合成的类语音信号：150Hz 基频的谐波，按约 4Hz 的音节节奏调幅，叠加少量噪声
+std::vector<float> make_warmup_clip(int sample_rate, float seconds) {
+    std::vector<float> clip(static_cast<size_t>(seconds * sample_rate));
+    std::mt19937 rng(16000);
+    std::normal_distribution<float> noise(0.0f, 0.005f);
+    const double two_pi = 2.0 * M_PI;
+    for (size_t i = 0; i < clip.size(); ++i) {
+        double t = static_cast<double>(i) / sample_rate;
+        double voiced = 0.0;
+        for (int k = 1; k <= 10; ++k) {
+            voiced += std::sin(two_pi * 150.0 * k * t) / k;
+        }
+        double envelope = 0.5 - 0.5 * std::cos(two_pi * 4.0 * t);
+        clip[i] = static_cast<float>(0.15 * envelope * voiced) + noise(rng);
+    }
+    return clip;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+AudioMonitor::AudioMonitor(const std::string& model_dir, const std::string& vad_model_path,
+                           const MonitorOptions& options)
+    : options_(options),
+      model_dir_(resolve_model_dir(model_dir)),
       vad_model_path_(vad_model_path),
       sample_rate_(16000),
       samples_per_read_(static_cast<int>(0.1 * 16000)),
+      vad_gate_(sample_rate_, options.vad_gate),
+      endpoint_(sample_rate_, options.endpoint),
       is_speech_detected_(false)
 {
     init_models();
 }
 
 AudioMonitor::~AudioMonitor() {
-    if (audio_stream_) {
-        if (Pa_IsStreamActive(audio_stream_)) {
-            Pa_StopStream(audio_stream_);
-        }
-        Pa_CloseStream(audio_stream_);
+}
+
+std::string AudioMonitor::resolve_model_dir(const std::string& model_dir) {
+    if (!model_dir.empty() && model_file_exists(model_dir + "/tokens.txt")) {
+        return model_dir;
     }
+    return "/home/lx/桌面/Voice/LLM_Voice_Flow-master/voice/models/sherpa-onnx-streaming-zipformer-small-bilingual-zh-en-2023-02-16";
 }
 
 void AudioMonitor::init_models() {
+    using Clock = std::chrono::steady_clock;
     std::cout << "正在初始化模型..." << std::endl;
-    init_vad();
-    init_asr();
-    std::cout << "模型初始化完成！" << std::endl;
-}
+    const auto start = Clock::now();
+    std::vector<std::pair<std::string, double>> phases;
 
-void AudioMonitor::init_vad() {
+    auto t0 = Clock::now();
     if (vad_model_path_.empty()) {
         vad_model_path_ = download_vad_model();
     }
-    VadModelConfig config;
-    config.silero_vad.model = vad_model_path_;
-    config.sample_rate = sample_rate_;
-    config.silero_vad.threshold = 0.5;
-    config.silero_vad.min_speech_duration = 0.25;
-    config.silero_vad.min_silence_duration = 0.5;
-    config.silero_vad.window_size = 512;
+    int asr_threads = options_.asr_threads;
+    ModelPrecision precision = ModelPrecision::Auto;
+    if (asr_threads <= 0) {
+        AsrTuning tuning;
+        std::string tuning_path = options_.tuning_file.empty() ? default_tuning_path() : options_.tuning_file;
+        if (load_asr_tuning(tuning_path, model_dir_, tuning)) {
+            asr_threads = tuning.num_threads;
+            precision = tuning.precision;
+            std::cout << "[Tuning] 使用本机校准结果: " << precision_name(precision) << "，" << asr_threads
+                      << " 线程 (RTF " << tuning.rtf << ")" << std::endl;
+        } else {
+            asr_threads = 4;
+        }
+    }
+    OnlineRecognizerConfig asr_config = make_online_recognizer_config(model_dir_, asr_threads, precision);
+    if (options_.endpoint.enabled) {
+        // 识别器按解码出的空白帧计算尾部静音，与能量判断互为补充；静音时长与 VAD 上限一致
+        asr_config.enable_endpoint = true;
+        asr_config.rule2_min_trailing_silence = options_.endpoint.max_silence_ms / 1000.0f;
+    }
+    const bool use_kws = !options_.kws_model_dir.empty();
+    KeywordSpotterConfig kws_config;
+    if (use_kws) {
+        kws_config = make_keyword_spotter_config(options_.kws_model_dir, options_.keywords_file, 1);
+    }
+    phases.emplace_back("查找模型文件", elapsed_ms(t0));
+
+    if (options_.prefetch_models) {
+        std::vector<std::string> files = model_files(asr_config);
+        files.push_back(vad_model_path_);
+        if (use_kws) {
+            auto kws_files = model_files(kws_config);
+            files.insert(files.end(), kws_files.begin(), kws_files.end());
+        }
+        PrefetchStats prefetch = prefetch_model_files(files);
+        phases.emplace_back("并行预读 " + std::to_string(prefetch.files) + " 个文件 (" +
+                                std::to_string(prefetch.bytes >> 20) + " MB)",
+                            prefetch.seconds * 1000.0);
+        if (prefetch.missing > 0) {
+            std::cerr << "警告：有 " << prefetch.missing << " 个模型文件无法读取" << std::endl;
+        }
+    }
+
+    // VAD (及 KWS) 与 ASR 的会话创建互不依赖，在两个线程中同时进行
+    t0 = Clock::now();
+    double side_ms = 0.0;
+    double asr_ms = 0.0;
+    std::exception_ptr side_error;
+    std::thread side_thread([&] {
+        try {
+            auto t = Clock::now();
+            init_vad();
+            if (use_kws) {
+                init_kws(kws_config);
+            }
+            side_ms = elapsed_ms(t);
+        } catch (...) {
+            side_error = std::current_exception();
+        }
+    });
+    try {
+        auto t = Clock::now();
+        init_asr(asr_config);
+        asr_ms = elapsed_ms(t);
+    } catch (...) {
+        side_thread.join();
+        throw;
+    }
+    side_thread.join();
+    if (side_error) {
+        std::rethrow_exception(side_error);
+    }
+    phases.emplace_back(use_kws ? "VAD+KWS 会话创建" : "VAD 会话创建", side_ms);
+    phases.emplace_back("ASR 会话创建", asr_ms);
+    phases.emplace_back("会话创建 (并行，墙上时间)", elapsed_ms(t0));
+
+    if (options_.warmup) {
+        t0 = Clock::now();
+        warm_up();
+        phases.emplace_back("预热", elapsed_ms(t0));
+    }
+
+    std::cout << "[Startup] 启动各阶段耗时:" << std::endl;
+    for (const auto& phase : phases) {
+        std::cout << "[Startup]   " << phase.first << ": " << phase.second << " ms" << std::endl;
+    }
+    std::cout << "[Startup] 模型就绪总耗时: " << elapsed_ms(start) << " ms" << std::endl;
+    std::cout << "模型初始化完成！" << std::endl;
+}
+
+void AudioMonitor::init_vad() {
+    float min_silence = options_.endpoint.enabled ? options_.endpoint.max_silence_ms / 1000.0f : 0.5f;
+    VadModelConfig config = make_vad_config(vad_model_path_, sample_rate_, min_silence);
 
     // 1. 修正：为 Create 方法提供第二个参数 (缓冲区大小，单位：秒)
     vad_ = std::make_unique<VoiceActivityDetector>(
@@ -64,24 +188,7 @@ void AudioMonitor::init_vad() {
     std::cout << "VAD模型初始化完成" << std::endl;
 }
 
-void AudioMonitor::init_asr() {
-    OnlineRecognizerConfig config;
-    config.model_config.transducer.encoder = model_dir_ + "/encoder-epoch-99-avg-1.int8.onnx";
-    config.model_config.transducer.decoder = model_dir_ + "/decoder-epoch-99-avg-1.int8.onnx";
-    config.model_config.transducer.joiner = model_dir_ + "/joiner-epoch-99-avg-1.int8.onnx";
-    config.model_config.tokens = model_dir_ + "/tokens.txt";
-
-    if (!file_exists(config.model_config.transducer.encoder)) {
-        std::cout << "未找到int8量化模型，尝试使用fp32模型..." << std::endl;
-        config.model_config.transducer.encoder = model_dir_ + "/encoder-epoch-99-avg-1.onnx";
-        config.model_config.transducer.decoder = model_dir_ + "/decoder-epoch-99-avg-1.onnx";
-        config.model_config.transducer.joiner = model_dir_ + "/joiner-epoch-99-avg-1.onnx";
-    } else {
-        std::cout << "使用int8量化模型以提高性能" << std::endl;
-    }
-    
-    config.model_config.num_threads = 4;
-    
+void AudioMonitor::init_asr(const OnlineRecognizerConfig& config) {
     // 2. 修正：使用 Create 返回的对象来构造 unique_ptr
     recognizer_ = std::make_unique<OnlineRecognizer>(
         OnlineRecognizer::Create(config)
@@ -89,9 +196,87 @@ void AudioMonitor::init_asr() {
     stream_ = std::make_unique<OnlineStream>(
         recognizer_->CreateStream()
     );
+    stream_pool_ = std::make_unique<StreamPool>(*recognizer_, options_.stream_pool_size);
     std::cout << "ASR模型初始化完成" << std::endl;
 }
 
+void AudioMonitor::warm_up() {
+    std::vector<float> clip;
+    if (!options_.warmup_wav.empty()) {
+        try {
+            MappedWav wav(options_.warmup_wav);
+            if (wav.sample_rate() == sample_rate_) {
+                clip.resize(std::min(wav.num_samples(), static_cast<size_t>(3 * sample_rate_)));
+                wav.to_float(0, clip.size(), clip.data());
+            } else {
+                std::cerr << "预热音频采样率不是 " << sample_rate_ << "，改用合成信号" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "预热音频读取失败 (" << e.what() << ")，改用合成信号" << std::endl;
+        }
+    }
+    if (clip.empty()) {
+        clip = make_warmup_clip(sample_rate_, 1.5f);
+    }
+
+    // 同一段音频跑两遍：第一遍是冷启动，第二遍即稳定状态下的耗时
+    double vad_ms[2];
+    double asr_ms[2];
+    double kws_ms[2] = {0.0, 0.0};
+    for (int pass = 0; pass < 2; ++pass) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset < clip.size(); offset += samples_per_read_) {
+            size_t n = std::min(clip.size() - offset, static_cast<size_t>(samples_per_read_));
+            vad_->AcceptWaveform(clip.data() + offset, static_cast<int32_t>(n));
+        }
+        vad_ms[pass] = elapsed_ms(t0);
+
+        t0 = std::chrono::steady_clock::now();
+        OnlineStream stream = recognizer_->CreateStream();
+        stream.AcceptWaveform(sample_rate_, clip.data(), static_cast<int32_t>(clip.size()));
+        stream.InputFinished();
+        while (recognizer_->IsReady(&stream)) {
+            recognizer_->Decode(&stream);
+        }
+        recognizer_->GetResult(&stream);
+        asr_ms[pass] = elapsed_ms(t0);
+
+        if (kws_) {
+            t0 = std::chrono::steady_clock::now();
+            OnlineStream kws_stream = kws_->CreateStream();
+            kws_stream.AcceptWaveform(sample_rate_, clip.data(), static_cast<int32_t>(clip.size()));
+            while (kws_->IsReady(&kws_stream)) {
+                kws_->Decode(&kws_stream);
+                kws_->GetResult(&kws_stream);
+            }
+            kws_ms[pass] = elapsed_ms(t0);
+        }
+    }
+    // 预热音频不能留在 VAD 里：清空其缓冲与状态，语音段位置重新从 0 开始计
+    vad_->Reset();
+
+    const double clip_ms = clip.size() * 1000.0 / sample_rate_;
+    std::cout << "[Warmup] 预热音频 " << clip_ms << " ms ("
+              << (options_.warmup_wav.empty() ? "合成" : options_.warmup_wav) << ")，冷启动 → 预热后:" << std::endl;
+    std::cout << "[Warmup] VAD " << vad_ms[0] << " ms → " << vad_ms[1] << " ms，ASR "
+              << asr_ms[0] << " ms → " << asr_ms[1] << " ms";
+    if (kws_) {
+        std::cout << "，KWS " << kws_ms[0] << " ms → " << kws_ms[1] << " ms";
+    }
+    std::cout << std::endl;
+}
+
+void AudioMonitor::init_kws(const KeywordSpotterConfig& config) {
+    kws_ = std::make_unique<KeywordSpotter>(KeywordSpotter::Create(config));
+    if (!kws_->Get()) {
+        std::cerr << "错误：KWS模型加载失败，唤醒模式已关闭" << std::endl;
+        kws_.reset();
+        return;
+    }
+    kws_stream_ = std::make_unique<OnlineStream>(kws_->CreateStream());
+    std::cout << "KWS模型初始化完成 (关键词: " << config.keywords_file << ")" << std::endl;
+}
+
 std::string AudioMonitor::download_vad_model() {
     std::string vad_model_path = "/home/lx/桌面/Voice/LLM_Voice_Flow-master/voice/models/sherpa-onnx-streaming-zipformer-small-bilingual-zh-en-2023-02-16/silero_vad.onnx";
     if (!file_exists(vad_model_path)) {
@@ -104,133 +289,479 @@ std::string AudioMonitor::download_vad_model() {
 }
 
 bool AudioMonitor::file_exists(const std::string& path) {
-    std::ifstream file(path);
-    return file.good();
+    return model_file_exists(path);
 }
 
-std::vector<AudioDevice> AudioMonitor::list_audio_devices() {
-    std::vector<AudioDevice> devices;
-    int num_devices = Pa_GetDeviceCount();
-    std::cout << "\n=== 可用的音频设备 ===" << std::endl;
-    for (int i = 0; i < num_devices; ++i) {
-        const PaDeviceInfo* device_info = Pa_GetDeviceInfo(i);
-        if (device_info && device_info->maxInputChannels > 0) {
-            AudioDevice device;
-            device.index = i;
-            device.name = device_info->name;
-            device.is_input = true;
-            devices.push_back(device);
-            std::cout << i << ": " << device.name << " (输入)" << std::endl;
+std::unique_ptr<PortAudioSource> AudioMonitor::create_device_source(int device_idx) const {
+    return std::make_unique<PortAudioSource>(device_idx, sample_rate_, samples_per_read_,
+                                             options_.capture_mode, options_.ring_buffer_seconds);
+}
+
+void AudioMonitor::start_monitoring(int device_idx, const std::function<void(const std::string&)>& callback) {
+    auto source = create_device_source(device_idx);
+    start_monitoring(*source, callback);
+}
+
+void AudioMonitor::start_monitoring(AudioSource& source, const std::function<void(const std::string&)>& callback) {
+    if (!begin(source, callback)) {
+        return;
+    }
+    while (g_running) {
+        ReadStatus status = process_pending(100);
+        if (status == ReadStatus::Finished || status == ReadStatus::Error) {
+            break;
         }
     }
-    int default_input = Pa_GetDefaultInputDevice();
-    if (default_input != paNoDevice) {
-        const PaDeviceInfo* default_info = Pa_GetDeviceInfo(default_input);
-        if (default_info) {
-            std::cout << "\n默认输入设备: " << default_info->name << " (索引 " << default_input << ")" << std::endl;
+    end();
+}
+
+bool AudioMonitor::begin(AudioSource& source, const std::function<void(const std::string&)>& callback) {
+    if (!source.start()) {
+        return false;
+    }
+    if (source.sample_rate() != sample_rate_) {
+        std::cerr << "错误：音频源采样率 " << source.sample_rate() << " 与模型要求的 "
+                  << sample_rate_ << " 不一致" << std::endl;
+        source.stop();
+        return false;
+    }
+
+    std::cout << "识别模式: " << (options_.streaming_asr ? "流式 (语音期间边说边解码)" : "分段 (VAD语音段结束后解码)")
+              << (kws_ ? "，唤醒词触发" : "") << std::endl;
+    std::cout << "请开始说话... (按Ctrl+C退出)" << std::endl;
+    std::cout << "--------------------------------------------------" << std::endl;
+
+    source_ = &source;
+    callback_ = callback;
+    samples_processed_ = 0;
+    busy_seconds_ = 0.0;
+    eou_latency_.clear();
+    finalize_compute_.clear();
+    eou_adaptive_.clear();
+    eou_recognizer_.clear();
+    eou_vad_.clear();
+    endpoint_silence_.clear();
+    endpoint_.start();
+    awaiting_vad_release_ = false;
+    stream_switch_.clear();
+    first_token_latency_.clear();
+    first_token_pending_ = false;
+    tts_muted_ = false;
+    barge_in_run_ = 0;
+    barge_ins_ = 0;
+    echo_canceller_.reset();
+    if (options_.aec.enabled) {
+        if (!echo_reference_) {
+            std::cerr << "[AEC] 未设置参考信号，回声消除不启用" << std::endl;
+        } else {
+            if (!source.is_realtime()) {
+                std::cerr << "[AEC] 音频源不是实时的，参考信号无法按时间对齐" << std::endl;
+            }
+            echo_canceller_ = std::make_unique<EchoCanceller>(options_.aec, sample_rate_);
+            capture_clock_ = CaptureClock(sample_rate_);
+            std::cout << "[AEC] 回声消除已启用: 滤波器 " << echo_canceller_->taps() << " 阶，参考延迟 "
+                      << options_.aec.delay_ms << " ms" << std::endl;
         }
     }
-    return devices;
+    vad_gate_.reset();
+    float preroll_seconds = options_.preroll_seconds;
+    if (kws_) {
+        preroll_seconds = std::max(preroll_seconds, options_.wake_handover_seconds);
+        awake_ = false;
+        wake_trim_pending_ = false;
+        awake_samples_ = 0;
+        wakeups_ = 0;
+        ignored_segments_ = 0;
+        kws_seconds_ = 0.0;
+    }
+    preroll_.reset(options_.streaming_asr ? static_cast<size_t>(preroll_seconds * sample_rate_) : 0);
+    run_start_ = std::chrono::steady_clock::now();
+    last_stats_ = run_start_;
+    return true;
 }
 
-void AudioMonitor::start_monitoring(int device_idx, const std::function<void(const std::string&)>& callback) {
-    PaError err = Pa_Initialize();
-    if (err != paNoError) {
-        std::cerr << "!!! PortAudio 初始化失败: " << Pa_GetErrorText(err) << std::endl;
-        return;
+ReadStatus AudioMonitor::process_pending(int timeout_ms) {
+    using Clock = std::chrono::steady_clock;
+    if (!source_) {
+        return ReadStatus::Error;
     }
 
-    auto devices = list_audio_devices();
-    if (devices.empty()) {
-        std::cerr << "错误：未找到任何音频输入设备。" << std::endl;
-        Pa_Terminate();
-        return;
+    AudioFrame frame;
+    ReadStatus status = source_->read(frame, samples_per_read_, timeout_ms);
+    if (status == ReadStatus::Ok) {
+        auto t0 = Clock::now();
+        process_audio(frame.data, frame.size, callback_);
+        busy_seconds_ += std::chrono::duration<double>(Clock::now() - t0).count();
+        samples_processed_ += frame.size;
     }
 
-    if (device_idx == -1) {
-        device_idx = Pa_GetDefaultInputDevice();
-        if (device_idx == paNoDevice) {
-            std::cerr << "错误：没有默认输入设备，将使用第一个可用设备。" << std::endl;
-            device_idx = devices[0].index;
+    if (options_.stats_interval_seconds > 0) {
+        auto now = Clock::now();
+        if (now - last_stats_ >= std::chrono::seconds(options_.stats_interval_seconds)) {
+            source_->print_stats();
+            last_stats_ = now;
         }
     }
+    return status;
+}
 
-    PaStreamParameters input_parameters;
-    input_parameters.device = device_idx;
-    input_parameters.channelCount = 1;
-    input_parameters.sampleFormat = paFloat32;
-    input_parameters.suggestedLatency = 0.1;
-    input_parameters.hostApiSpecificStreamInfo = nullptr;
-
-    err = Pa_OpenStream(&audio_stream_, &input_parameters, nullptr, sample_rate_,
-                        samples_per_read_, paNoFlag, nullptr, nullptr);
-    if (err != paNoError) {
-        std::cerr << "打开音频流失败: " << Pa_GetErrorText(err) << std::endl;
-        Pa_Terminate();
+void AudioMonitor::end() {
+    if (!source_) {
         return;
     }
+    wall_seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start_).count();
+    source_->stop();
+    print_run_summary(*source_);
+    source_ = nullptr;
+    callback_ = nullptr;
+}
 
-    err = Pa_StartStream(audio_stream_);
-    if (err != paNoError) {
-        std::cerr << "启动音频流失败: " << Pa_GetErrorText(err) << std::endl;
-        Pa_CloseStream(audio_stream_);
-        Pa_Terminate();
+void AudioMonitor::process_audio(const float* samples, size_t n,
+                                 const std::function<void(const std::string&)>& callback) {
+    if (echo_canceller_) {
+        // 回声消除在最前面：播放期间被丢弃的帧也要参与滤波器自适应，后面的门限/VAD/ASR 都使用消除后的信号
+        aec_reference_.resize(n);
+        aec_output_.resize(n);
+        int64_t capture_us = capture_clock_.stamp(n) - static_cast<int64_t>(options_.aec.delay_ms * 1000.0f);
+        echo_reference_->read(capture_us, aec_reference_.data(), n);
+        echo_canceller_->process(samples, aec_reference_.data(), aec_output_.data(), n);
+        samples = aec_output_.data();
+    }
+    // TTS 播放期间默认丢弃音频；开启插话检测时照常送入 VAD。用户已在说话时不再丢弃，保证这句话完整
+    const bool tts_playing = g_is_tts_speaking && !(options_.barge_in && is_speech_detected_);
+    if (tts_playing && !(options_.barge_in && asr_active())) {
         return;
     }
-    
-    std::cout << "\n成功打开设备: " << Pa_GetDeviceInfo(device_idx)->name << " (索引 " << device_idx << ")" << std::endl;
-    std::cout << "请开始说话... (按Ctrl+C退出)" << std::endl;
-    std::cout << "--------------------------------------------------" << std::endl;
+    if (tts_muted_ && !tts_playing) {
+        // 播放结束且未被打断：VAD 中残留的回声不当作语音
+        vad_->Flush();
+        vad_->Clear();
+        barge_in_run_ = 0;
+    }
+    tts_muted_ = tts_playing;
 
-    std::vector<float> buffer(samples_per_read_);
-    while (g_running) {
-        err = Pa_ReadStream(audio_stream_, buffer.data(), samples_per_read_);
-        if (err != paNoError) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(20));
-            continue;
+    auto chunk_start = std::chrono::steady_clock::now();
+    // 门限关闭时本帧不送入 VAD；vad_samples_ 只计实际送入的采样，与 VAD 语音段的位置一致
+    // 休眠时 KWS 与 VAD 收到同样的音频，两者的采样位置一致
+    const bool feed_kws = kws_ && !awake_;
+    vad_samples_ += vad_gate_.process(samples, n, is_speech_detected_, [this, feed_kws](const float* s, size_t len) {
+        vad_->AcceptWaveform(s, static_cast<int32_t>(len));
+        if (feed_kws) {
+            kws_stream_->AcceptWaveform(sample_rate_, s, static_cast<int32_t>(len));
         }
+    });
+    if (feed_kws) {
+        detect_keyword();
+    } else if (kws_ && !is_speech_detected_ && samples_processed_ >= awake_until_sample_) {
+        go_to_sleep();
+    }
+    if (awake_) {
+        awake_samples_ += n;
+    }
+    if (tts_playing && !detect_barge_in(samples, n)) {
+        return;
+    }
 
-        if (g_is_tts_speaking) {
-            continue;
+    const bool use_endpoint = options_.endpoint.enabled && options_.streaming_asr;
+    if (use_endpoint && asr_active()) {
+        endpoint_.observe(samples, n, vad_gate_.noise_floor_db());
+    }
+    bool onset = vad_->IsDetected() && !is_speech_detected_;
+    if (awaiting_vad_release_) {
+        // 上一句已提前结束而 VAD 仍判定为语音：等 VAD 判定静音，或能量显示已开始说下一句
+        if (!vad_->IsDetected()) {
+            awaiting_vad_release_ = false;
+        } else if (endpoint_.voiced_run_ms() >= options_.endpoint.reonset_ms) {
+            awaiting_vad_release_ = false;
+        } else {
+            onset = false;
         }
-        
-        vad_->AcceptWaveform(buffer.data(), buffer.size());
+    }
 
-        if (vad_->IsDetected() && !is_speech_detected_) {
+    if (onset) {
+        is_speech_detected_ = true;
+        endpoint_.start();
+        if (asr_active()) {
             std::cout << "\n🎤 检测到语音..." << std::endl;
-            is_speech_detected_ = true;
-            last_result_.clear();
+            begin_utterance(chunk_start);
         }
+        last_result_.clear();
+        if (options_.streaming_asr && asr_active()) {
+            // 补送语音起始前的历史音频，弥补 VAD 判定语音所需的时间
+            preroll_.latest(preroll_.capacity(), preroll_scratch_);
+            stream_->AcceptWaveform(sample_rate_, preroll_scratch_.data(), preroll_scratch_.size());
+        }
+    }
 
+    EndpointReason endpoint = EndpointReason::None;
+    if (options_.streaming_asr) {
+        // 音频已在语音期间直接送入 ASR，VAD 语音段只用于记录语音结束位置
         while (!vad_->IsEmpty()) {
             auto segment = vad_->Front();
-            // 3. 修正：使用类成员变量 sample_rate_
-            stream_->AcceptWaveform(sample_rate_, segment.samples.data(), segment.samples.size());
-            while (recognizer_->IsReady(stream_.get())) {
-                recognizer_->Decode(stream_.get());
+            speech_end_sample_ = static_cast<uint64_t>(segment.start) + segment.samples.size();
+            vad_->Pop();
+        }
+        if (is_speech_detected_ && asr_active()) {
+            stream_->AcceptWaveform(sample_rate_, samples, n);
+            if (decode_stream()) {
+                stable_frames_ = 0;
+            } else if (stable_callback_ && options_.stable_frames > 0 && !last_result_.empty() &&
+                       ++stable_frames_ == options_.stable_frames) {
+                stable_callback_(last_result_);
+            }
+            if (use_endpoint) {
+                endpoint_.update_text(last_result_);
+                if (endpoint_.should_finalize()) {
+                    endpoint = EndpointReason::Adaptive;
+                } else if (recognizer_->IsEndpoint(stream_.get())) {
+                    endpoint = EndpointReason::Recognizer;
+                }
             }
-            auto result = recognizer_->GetResult(stream_.get());
-            if (!result.text.empty() && result.text != last_result_) {
-                last_result_ = result.text;
-                std::cout << "📝 识别结果: " << result.text << std::endl;
+        }
+        preroll_.append(samples, n);
+    } else {
+        while (!vad_->IsEmpty()) {
+            auto segment = vad_->Front();
+            speech_end_sample_ = static_cast<uint64_t>(segment.start) + segment.samples.size();
+            if (asr_active()) {
+                size_t offset = 0;
+                if (wake_trim_pending_) {
+                    // 唤醒词之前的部分 (电视声、闲聊) 不交给识别器
+                    uint64_t from = wake_vad_sample_ -
+                                    std::min<uint64_t>(wake_vad_sample_, options_.wake_handover_seconds * sample_rate_);
+                    if (from > static_cast<uint64_t>(segment.start)) {
+                        offset = std::min<size_t>(segment.samples.size(), from - segment.start);
+                    }
+                    wake_trim_pending_ = false;
+                }
+                // 3. 修正：使用类成员变量 sample_rate_
+                stream_->AcceptWaveform(sample_rate_, segment.samples.data() + offset,
+                                        segment.samples.size() - offset);
+                decode_stream();
             }
             vad_->Pop();
         }
-        
-        if (!vad_->IsDetected() && is_speech_detected_) {
-            std::cout << "🔇 语音结束" << std::endl;
-            is_speech_detected_ = false;
-            if (!last_result_.empty()) {
-                callback(last_result_);
+    }
+    
+    if (endpoint != EndpointReason::None) {
+        finish_utterance(callback, chunk_start, endpoint);
+        awaiting_vad_release_ = vad_->IsDetected();
+    } else if (!vad_->IsDetected() && is_speech_detected_) {
+        finish_utterance(callback, chunk_start, EndpointReason::Vad);
+    }
+}
+
+void AudioMonitor::detect_keyword() {
+    auto t0 = std::chrono::steady_clock::now();
+    std::string keyword;
+    while (kws_->IsReady(kws_stream_.get())) {
+        kws_->Decode(kws_stream_.get());
+        auto result = kws_->GetResult(kws_stream_.get());
+        if (!result.keyword.empty()) {
+            keyword = result.keyword;
+            kws_->Reset(kws_stream_.get());
+            break;
+        }
+    }
+    kws_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (keyword.empty()) {
+        return;
+    }
+
+    std::cout << "\n🔔 唤醒词: " << keyword << std::endl;
+    awake_ = true;
+    ++wakeups_;
+    awake_until_sample_ = samples_processed_ + static_cast<uint64_t>(options_.wake_window_seconds * sample_rate_);
+    if (!is_speech_detected_) {
+        return;
+    }
+    // 唤醒词与指令连在一句话里：把唤醒点之前的一小段音频交给识别器
+    std::cout << "🎤 检测到语音..." << std::endl;
+    begin_utterance(std::chrono::steady_clock::now());
+    if (options_.streaming_asr) {
+        preroll_.latest(static_cast<size_t>(options_.wake_handover_seconds * sample_rate_), preroll_scratch_);
+        stream_->AcceptWaveform(sample_rate_, preroll_scratch_.data(), preroll_scratch_.size());
+    } else {
+        wake_trim_pending_ = true;
+        wake_vad_sample_ = vad_samples_;
+    }
+}
+
+bool AudioMonitor::detect_barge_in(const float* samples, size_t n) {
+    // 回声通常比贴近麦克风的人声弱，要求比送入 VAD 更高的能量余量
+    FrameFeatures features = compute_frame_features(samples, n, static_cast<size_t>(sample_rate_ / 100));
+    bool loud = features.max_energy_db - vad_gate_.noise_floor_db() >= options_.barge_in_margin_db;
+    barge_in_run_ = loud && vad_->IsDetected() ? barge_in_run_ + n : 0;
+    if (barge_in_run_ < static_cast<uint64_t>(options_.barge_in_ms * sample_rate_ / 1000.0f)) {
+        // 回声形成的语音段直接丢弃；预录缓冲照常更新，打断时识别器能拿到语音起始
+        vad_->Clear();
+        if (options_.streaming_asr) {
+            preroll_.append(samples, n);
+        }
+        return false;
+    }
+    std::cout << "\n⏹ 检测到插话 (持续 " << barge_in_run_ * 1000 / sample_rate_ << " ms)，打断播放" << std::endl;
+    ++barge_ins_;
+    barge_in_run_ = 0;
+    tts_muted_ = false;
+    if (barge_in_callback_) {
+        barge_in_callback_(utterance_id_);
+    }
+    return true;
+}
+
+void AudioMonitor::go_to_sleep() {
+    awake_ = false;
+    wake_trim_pending_ = false;
+    // 休眠期间 KWS 流从干净的状态开始
+    kws_stream_ = std::make_unique<OnlineStream>(kws_->CreateStream());
+    std::cout << "💤 进入休眠，等待唤醒词..." << std::endl;
+}
+
+bool AudioMonitor::decode_stream() {
+    while (recognizer_->IsReady(stream_.get())) {
+        recognizer_->Decode(stream_.get());
+    }
+    auto result = recognizer_->GetResult(stream_.get());
+    if (!result.text.empty() && first_token_pending_) {
+        first_token_pending_ = false;
+        first_token_latency_.add(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - onset_time_).count());
+    }
+    if (!result.text.empty() && result.text != last_result_) {
+        last_result_ = result.text;
+        std::cout << "📝 识别结果: " << result.text << std::endl;
+        publish_hypothesis(false);
+        return true;
+    }
+    return false;
+}
+
+void AudioMonitor::begin_utterance(std::chrono::steady_clock::time_point now) {
+    onset_time_ = now;
+    first_token_pending_ = true;
+    ++utterance_id_;
+    onset_sample_ = samples_processed_;
+    onset_wall_us_ = now_us();
+    hypothesis_published_ = false;
+    stable_frames_ = 0;
+}
+
+void AudioMonitor::publish_hypothesis(bool final) {
+    if (!hypothesis_callback_) {
+        return;
+    }
+    // 没有发过中间结果的空句 (噪声) 不发送最终结果
+    if (final && !hypothesis_published_ && last_result_.empty()) {
+        return;
+    }
+    HypothesisUpdate update;
+    update.utterance_id = utterance_id_;
+    update.text = last_result_;
+    update.final = final;
+    update.audio_ms = static_cast<uint32_t>((samples_processed_ - onset_sample_) * 1000 / sample_rate_);
+    update.utterance_start_us = onset_wall_us_;
+    hypothesis_callback_(update);
+    hypothesis_published_ = true;
+}
+
+void AudioMonitor::finish_utterance(const std::function<void(const std::string&)>& callback,
+                                    std::chrono::steady_clock::time_point chunk_start,
+                                    EndpointReason reason) {
+    if (!asr_active()) {
+        // 休眠期间的语音 (未说唤醒词) 不识别、不发送
+        is_speech_detected_ = false;
+        ++ignored_segments_;
+        return;
+    }
+    if (kws_) {
+        awake_until_sample_ = samples_processed_ + static_cast<uint64_t>(options_.wake_window_seconds * sample_rate_);
+    }
+    if (options_.streaming_asr) {
+        // 流式模式下大部分音频已解码，这里只需冲刷尾部
+        stream_->InputFinished();
+        decode_stream();
+    }
+
+    const bool use_endpoint = options_.endpoint.enabled && options_.streaming_asr;
+    if (use_endpoint) {
+        std::cout << "🔇 语音结束 (" << endpoint_reason_name(reason) << "，尾部静音 "
+                  << endpoint_.trailing_silence_ms() << " ms)" << std::endl;
+    } else {
+        std::cout << "🔇 语音结束" << std::endl;
+    }
+    is_speech_detected_ = false;
+    if (!last_result_.empty()) {
+        // 端点延迟 = 语音结束后已送入的音频时长 (含静音判定) + 本帧处理耗时。
+        // VAD 尚未输出语音段时，语音结束位置以能量判断的尾部静音为准
+        double audio_delay_ms = reason == EndpointReason::Vad
+                                    ? (vad_samples_ - speech_end_sample_) * 1000.0 / sample_rate_
+                                    : endpoint_.trailing_silence_ms();
+        double compute_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - chunk_start).count();
+        eou_latency_.add(audio_delay_ms + compute_ms);
+        finalize_compute_.add(compute_ms);
+        if (use_endpoint) {
+            switch (reason) {
+                case EndpointReason::Adaptive:
+                    eou_adaptive_.add(audio_delay_ms + compute_ms);
+                    endpoint_silence_.add(endpoint_.required_silence_ms());
+                    break;
+                case EndpointReason::Recognizer:
+                    eou_recognizer_.add(audio_delay_ms + compute_ms);
+                    break;
+                default:
+                    eou_vad_.add(audio_delay_ms + compute_ms);
+                    break;
             }
-            // 3. 修正 unique_ptr 的重新赋值
-            stream_ = std::make_unique<OnlineStream>(recognizer_->CreateStream());
         }
     }
+    publish_hypothesis(true);
+    if (!last_result_.empty()) {
+        callback(last_result_);
+    }
+    first_token_pending_ = false;
+    // 换上池中预先创建好的流，旧流交给后台线程释放
+    auto t0 = std::chrono::steady_clock::now();
+    stream_pool_->release(std::move(stream_));
+    stream_ = stream_pool_->acquire();
+    stream_switch_.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+}
 
-    Pa_StopStream(audio_stream_);
-    Pa_CloseStream(audio_stream_);
-    Pa_Terminate();
+void AudioMonitor::print_run_summary(const AudioSource& source) const {
+    double audio_seconds = static_cast<double>(samples_processed_) / sample_rate_;
+    std::cout << "\n===== 运行统计 (" << source.name() << ") =====" << std::endl;
+    source.print_stats();
+    std::cout << "[Stats] 音频时长 " << audio_seconds << " 秒，墙上时间 " << wall_seconds_
+              << " 秒，处理耗时 " << busy_seconds_ << " 秒" << std::endl;
+    if (audio_seconds > 0) {
+        std::cout << "[Stats] 实时率 RTF = " << busy_seconds_ / audio_seconds
+                  << " (处理耗时 / 音频时长)" << std::endl;
+    }
+    vad_gate_.print_stats(kws_ ? "VAD+KWS门限" : "VAD门限");
+    if (kws_ && samples_processed_ > 0) {
+        std::cout << "[Wake] 唤醒 " << wakeups_ << " 次，休眠期间忽略语音 " << ignored_segments_
+                  << " 段，完整识别器工作的音频占比 " << 100.0 * awake_samples_ / samples_processed_
+                  << "%，KWS解码耗时 " << kws_seconds_ << " 秒" << std::endl;
+    }
+    if (options_.barge_in) {
+        std::cout << "[BargeIn] 播放期间检测到插话 " << barge_ins_ << " 次" << std::endl;
+    }
+    if (echo_canceller_) {
+        echo_canceller_->print_stats();
+        echo_reference_->print_stats();
+    }
+    eou_latency_.print();
+    if (options_.endpoint.enabled && options_.streaming_asr) {
+        eou_adaptive_.print();
+        eou_recognizer_.print();
+        eou_vad_.print();
+        endpoint_silence_.print();
+    }
+    finalize_compute_.print();
+    first_token_latency_.print();
+    stream_switch_.print();
+    stream_pool_->print_stats();
 }
 
 // #include <iostream>
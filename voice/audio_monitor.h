@@ -7,42 +7,207 @@
 #include <functional>
 #include <memory>
 #include <atomic>      // <--- 1. 增加了 <atomic> 头文件
-#include <portaudio.h> // <--- 2. 直接包含 <portaudio.h>
+#include <chrono>
 #include <sherpa-onnx/c-api/cxx-api.h>
+#include "audio_history.h"
+#include "audio_source.h"
+#include "echo_canceller.h"
+#include "echo_reference.h"
+#include "endpoint_detector.h"
+#include "latency_stats.h"
+#include "partial_hypothesis.h"
+#include "portaudio_source.h"
+#include "stream_pool.h"
+#include "vad_gate.h"
 
-struct AudioDevice {
-    int index;
-    std::string name;
-    bool is_input;
+struct MonitorOptions {
+    CaptureMode capture_mode = CaptureMode::Blocking;
+    float ring_buffer_seconds = 2.0f;   // 回调模式下环形缓冲区可容纳的音频时长
+    int stats_interval_seconds = 10;    // 打印音频源统计的间隔，<=0 表示只在退出时打印
+
+    // 流式识别：VAD 判定为语音期间持续把音频送入 OnlineStream 边说边解码，
+    // 而不是等 VAD 输出完整语音段后再一次性解码
+    bool streaming_asr = false;
+    float preroll_seconds = 0.5f;       // 流式识别时，语音起始前补送给 ASR 的历史音频时长
+    size_t stream_pool_size = 2;        // 后台预先创建的识别流数量，0 表示每句结束时在处理线程中创建
+    // 流式识别时中间结果连续多少帧未变化即视为稳定，调用 stable 回调 (用于推测发送)，0 表示不检测
+    int stable_frames = 0;
+
+    // 自适应端点 (需流式识别)：按尾部静音、文本稳定性和语音时长提前结束一句话，
+    // VAD 的静音时长放宽为 endpoint.max_silence_ms 作为上限
+    EndpointOptions endpoint;
+
+    bool prefetch_models = true;        // 创建会话前并行把模型文件读入页缓存
+
+    // 识别器推理线程数与模型精度：asr_threads <= 0 时读取本机的 --calibrate 结果，没有则为 4 线程/优先 int8
+    int asr_threads = 0;
+    std::string tuning_file;            // 为空时使用 default_tuning_path()
+
+    // 启动预热：报告就绪前先让 VAD/ASR (及 KWS) 各跑一段音频，首次推理的内存分配和内核选择不落在用户的第一句话上
+    bool warmup = true;
+    std::string warmup_wav;             // 预热用的 WAV 文件，为空时使用合成的类语音信号
+
+    // 插话检测：TTS 播放期间照常运行 VAD，语音持续 barge_in_ms 且能量高出噪声基底 barge_in_margin_db
+    // (用于排除回声) 即视为用户打断，调用 barge-in 回调并开始识别这句话。关闭时播放期间的音频全部丢弃
+    bool barge_in = false;
+    float barge_in_ms = 300.0f;
+    float barge_in_margin_db = 15.0f;
+
+    // 回声消除：以 TTS 播放的 PCM 为参考，在门限/VAD/ASR 之前消除扬声器回声 (需 set_echo_reference)
+    EchoCancellerOptions aec;
+
+    // VAD 前的能量/过零率门限：明显的静音帧不做 Silero 推理
+    VadGateOptions vad_gate;
+
+    // 唤醒模式：指定 KWS 模型目录后，完整识别器只在检测到唤醒词后运行
+    std::string kws_model_dir;
+    std::string keywords_file;          // 为空时使用 KWS 模型目录下的 keywords.txt
+    float wake_window_seconds = 8.0f;   // 唤醒后 (及每句结束后) 多久没有新的语音即回到休眠
+    float wake_handover_seconds = 0.5f; // 唤醒时交给识别器的唤醒点之前的音频时长
 };
 
 class AudioMonitor {
 public:
-    AudioMonitor(const std::string& model_dir, const std::string& vad_model_path = "");
+    AudioMonitor(const std::string& model_dir, const std::string& vad_model_path = "",
+                 const MonitorOptions& options = MonitorOptions());
     ~AudioMonitor();
+    // 使用 PortAudio 设备作为输入
     void start_monitoring(int device_idx, const std::function<void(const std::string&)>& callback);
+    // 使用任意音频源作为输入 (如 WAV 文件回放)
+    void start_monitoring(AudioSource& source, const std::function<void(const std::string&)>& callback);
+
+    // 构造函数实际使用的模型目录：指定的目录中没有 tokens.txt 时使用内置的默认目录
+    static std::string resolve_model_dir(const std::string& model_dir);
+
+    // 识别结果每次变化 (中间结果) 及一句话结束 (最终结果) 时调用，在处理线程中执行
+    void set_hypothesis_callback(std::function<void(const HypothesisUpdate&)> callback) {
+        hypothesis_callback_ = std::move(callback);
+    }
+
+    // 中间结果稳定 (连续 options.stable_frames 帧未变化) 时调用，每次稳定只调用一次，在处理线程中执行
+    void set_stable_callback(std::function<void(const std::string&)> callback) {
+        stable_callback_ = std::move(callback);
+    }
+
+    // TTS 播放期间检测到插话时调用，参数为被打断的回答所对应的句子编号，在处理线程中执行
+    void set_barge_in_callback(std::function<void(uint64_t)> callback) {
+        barge_in_callback_ = std::move(callback);
+    }
+
+    int sample_rate() const { return sample_rate_; }
+
+    // 回声消除的参考信号 (由接收线程写入)，须在 begin() 之前设置
+    void set_echo_reference(std::shared_ptr<EchoReference> reference) { echo_reference_ = std::move(reference); }
+
+    // 按监控器的采样率和帧长创建 PortAudio 输入源
+    std::unique_ptr<PortAudioSource> create_device_source(int device_idx) const;
+
+    // 事件驱动用法：begin() 之后在音频源可读 (ready_fd) 时调用 process_pending()，
+    // 结束时调用 end()。start_monitoring() 即是以阻塞读取驱动的同一流程。
+    bool begin(AudioSource& source, const std::function<void(const std::string&)>& callback);
+    // 读取并处理至多一帧，返回读取状态；Finished/Error 表示应结束
+    ReadStatus process_pending(int timeout_ms);
+    void end();
 
 private:
+    void process_audio(const float* samples, size_t n,
+                       const std::function<void(const std::string&)>& callback);
+    // 返回识别结果是否有变化
+    bool decode_stream();
+    void begin_utterance(std::chrono::steady_clock::time_point now);
+    void publish_hypothesis(bool final);
+    void finish_utterance(const std::function<void(const std::string&)>& callback,
+                          std::chrono::steady_clock::time_point chunk_start, EndpointReason reason);
+    void print_run_summary(const AudioSource& source) const;
     void init_models();
     void init_vad();
-    void init_asr();
+    void init_asr(const sherpa_onnx::cxx::OnlineRecognizerConfig& config);
+    void init_kws(const sherpa_onnx::cxx::KeywordSpotterConfig& config);
+    void warm_up();
+    bool asr_active() const { return !kws_ || awake_; }
+    void detect_keyword();
+    bool detect_barge_in(const float* samples, size_t n);
+    void go_to_sleep();
     std::string download_vad_model();
     bool file_exists(const std::string& path);
-    std::vector<AudioDevice> list_audio_devices();
 
+    // begin() 与 end() 之间有效
+    AudioSource* source_ = nullptr;
+    std::function<void(const std::string&)> callback_;
+    std::chrono::steady_clock::time_point run_start_;
+    std::chrono::steady_clock::time_point last_stats_;
+
+    MonitorOptions options_;
     std::string model_dir_;
     std::string vad_model_path_;
     int sample_rate_;
     int samples_per_read_;
     
     std::unique_ptr<sherpa_onnx::cxx::OnlineRecognizer> recognizer_;
+    std::unique_ptr<StreamPool> stream_pool_;
     std::unique_ptr<sherpa_onnx::cxx::VoiceActivityDetector> vad_;
+    VadGate vad_gate_;
+    EndpointDetector endpoint_;
+    bool awaiting_vad_release_ = false; // 自适应端点已结束上一句，VAD 仍处于语音状态
     std::unique_ptr<sherpa_onnx::cxx::OnlineStream> stream_;
+
+    // 唤醒模式：休眠时只有 KWS 处理音频 (与 VAD 共用门限，静音帧两者都跳过)
+    std::unique_ptr<sherpa_onnx::cxx::KeywordSpotter> kws_;
+    std::unique_ptr<sherpa_onnx::cxx::OnlineStream> kws_stream_;
+    bool awake_ = false;
+    bool wake_trim_pending_ = false;    // 分段模式下，唤醒所在的语音段只交出唤醒点前 handover 之后的部分
+    uint64_t wake_vad_sample_ = 0;
+    uint64_t awake_until_sample_ = 0;
+    uint64_t awake_samples_ = 0;
+    uint64_t wakeups_ = 0;
+    uint64_t ignored_segments_ = 0;
+    double kws_seconds_ = 0.0;
     
     std::atomic<bool> is_speech_detected_; // 3. 移除了不必要的初始化
     std::string last_result_;
-    
-    PaStream* audio_stream_ = nullptr; // 4. 将 struct PaStream* 改为 PaStream*
+
+    // 运行统计：送入 VAD 的采样数以 VAD 内部计数为准，用于换算语音结束时刻
+    uint64_t vad_samples_ = 0;
+    uint64_t speech_end_sample_ = 0;
+    uint64_t samples_processed_ = 0;
+    double busy_seconds_ = 0.0;
+    double wall_seconds_ = 0.0;
+    LatencyStats eou_latency_{"语音结束→最终文本"};
+    LatencyStats finalize_compute_{"端点帧处理耗时"};
+    LatencyStats eou_adaptive_{"语音结束→最终文本 (自适应端点)"};
+    LatencyStats eou_recognizer_{"语音结束→最终文本 (识别器端点规则)"};
+    LatencyStats eou_vad_{"语音结束→最终文本 (VAD静音)"};
+    LatencyStats endpoint_silence_{"端点处要求的尾部静音"};
+    LatencyStats stream_switch_{"换用新识别流耗时"};
+    LatencyStats first_token_latency_{"语音开始→首个识别结果"};
+    std::chrono::steady_clock::time_point onset_time_;
+    bool first_token_pending_ = false;
+
+    // 中间/最终结果的订阅者 (如 ZMQ PUB)
+    std::function<void(const HypothesisUpdate&)> hypothesis_callback_;
+    uint64_t utterance_id_ = 0;
+    uint64_t onset_sample_ = 0;
+    int64_t onset_wall_us_ = 0;
+    bool hypothesis_published_ = false;
+    std::function<void(const std::string&)> stable_callback_;
+    int stable_frames_ = 0;
+
+    // 插话检测
+    std::function<void(uint64_t)> barge_in_callback_;
+    bool tts_muted_ = false;            // 上一帧是否处于 TTS 播放 (只检测插话) 状态
+    uint64_t barge_in_run_ = 0;         // 连续满足插话条件的采样数
+    uint64_t barge_ins_ = 0;
+
+    // 回声消除：按采集时刻从参考缓冲区取出对齐的 TTS 信号
+    std::shared_ptr<EchoReference> echo_reference_;
+    std::unique_ptr<EchoCanceller> echo_canceller_;
+    CaptureClock capture_clock_{sample_rate_};
+    std::vector<float> aec_reference_;
+    std::vector<float> aec_output_;
+
+    // 流式识别的预录缓冲及其读出用的临时缓冲
+    AudioHistory preroll_;
+    std::vector<float> preroll_scratch_;
 };
 
 #endif // AUDIO_MONITOR_H
\ No newline at end of file
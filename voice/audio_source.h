@@ -0,0 +1,47 @@
+// audio_source.h
+// 音频输入源抽象：AudioMonitor 只通过该接口取数据，
+// 具体来源可以是 PortAudio 实时设备，也可以是录制好的 WAV 文件。
+#ifndef AUDIO_SOURCE_H
+#define AUDIO_SOURCE_H
+
+#include <cstddef>
+#include <string>
+
+// 一帧单声道 float 采样。data 由音频源持有，仅在下一次 read() 之前有效。
+struct AudioFrame {
+    const float* data = nullptr;
+    size_t size = 0;
+};
+
+enum class ReadStatus {
+    Ok,         // frame 中有数据
+    NotReady,   // 超时或暂时无数据，可稍后重试
+    Finished,   // 数据已读完 (文件源)
+    Error       // 不可恢复的错误
+};
+
+class AudioSource {
+public:
+    virtual ~AudioSource() = default;
+
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+
+    // 读取最多 max_samples 个采样。timeout_ms < 0 表示一直等待。
+    virtual ReadStatus read(AudioFrame& frame, size_t max_samples, int timeout_ms) = 0;
+
+    virtual int sample_rate() const = 0;
+    virtual std::string name() const = 0;
+
+    // 有新数据时变为可读的文件描述符 (如 eventfd)，供事件循环等待；
+    // 返回 -1 表示不支持，只能通过阻塞的 read() 取数据。需在 start() 之后调用
+    virtual int ready_fd() const { return -1; }
+
+    // 音频时钟是否与墙上时钟一致 (实时设备或按实时节奏回放的文件)
+    virtual bool is_realtime() const { return true; }
+
+    // 打印源自身的统计信息 (缓冲区占用、溢出等)
+    virtual void print_stats() const {}
+};
+
+#endif // AUDIO_SOURCE_H
@@ -0,0 +1,43 @@
+// control_message.h
+// 语音助手 → LLM/TTS 服务的控制消息，经 ZMQ PUB 以单帧文本发布 (与 TTS 的 "STATUS::" 状态消息同一风格)，
+// 服务端订阅 "CONTROL::" 前缀即可。
+//   CONTROL::CANCEL <会话ID> <句子编号>
+// 用户打断播放时发布：服务端应立即停止该会话所有进行中的生成与播放，释放算力。
+// 句子编号为被打断的回答所对应的识别结果编号，用于日志与关联；请求本身不带编号，服务端按会话取消即可。
+//   CONTROL::DISCARD <会话ID> <推测编号>
+// 已发出的推测请求未命中 (最终文本不同) 或被更新的中间结果取代时发布：服务端停止生成该推测请求。
+// 只作用于编号相同的推测请求，迟到的 DISCARD 不会误伤之后的请求 (这是它与 CANCEL 分开的原因)。
+//
+// 推测请求经 LLM 请求通道以 "SPECULATE::<推测编号> <文本>" 发送：服务端只生成、不送TTS播放，保存回答后回复。
+// 之后收到与其文本相同的普通请求即为确认 (命中)，直接播放保存的回答；收到其他请求则丢弃保存的回答。
+#ifndef CONTROL_MESSAGE_H
+#define CONTROL_MESSAGE_H
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+constexpr const char* kControlPrefix = "CONTROL::";
+constexpr const char* kControlCancel = "CONTROL::CANCEL";
+constexpr const char* kControlDiscard = "CONTROL::DISCARD";
+constexpr const char* kSpeculatePrefix = "SPECULATE::";
+
+inline std::string make_cancel_message(const std::string& session_id, uint64_t utterance_id) {
+    return std::string(kControlCancel) + " " + session_id + " " + std::to_string(utterance_id);
+}
+
+inline bool parse_cancel_message(const std::string& message, std::string& session_id, uint64_t& utterance_id) {
+    std::istringstream in(message);
+    std::string verb;
+    return (in >> verb >> session_id >> utterance_id) && verb == kControlCancel;
+}
+
+inline std::string make_discard_message(const std::string& session_id, uint64_t speculation_id) {
+    return std::string(kControlDiscard) + " " + session_id + " " + std::to_string(speculation_id);
+}
+
+inline std::string make_speculative_request(uint64_t speculation_id, const std::string& text) {
+    return std::string(kSpeculatePrefix) + std::to_string(speculation_id) + " " + text;
+}
+
+#endif // CONTROL_MESSAGE_H
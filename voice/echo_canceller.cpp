@@ -0,0 +1,118 @@
+// echo_canceller.cpp
+// NLMS 回声消除与 Geigel 双讲检测
+
+#include "echo_canceller.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+EchoCanceller::EchoCanceller(const EchoCancellerOptions& options, int sample_rate)
+    : options_(options),
+      sample_rate_(sample_rate)
+{
+    // 取整到峰值块的整数倍，点积循环也因此没有尾部
+    size_t taps = static_cast<size_t>(options_.filter_ms * sample_rate_ / 1000.0f);
+    taps_ = std::max<size_t>(1, (taps + kPeakBlock - 1) / kPeakBlock) * kPeakBlock;
+    hold_samples_ = static_cast<size_t>(options_.double_talk_hold_ms * sample_rate_ / 1000.0f);
+    weights_.assign(taps_, 0.0f);
+    history_.assign(taps_ * 2, 0.0f);
+    block_peaks_.assign(taps_ / kPeakBlock, 0.0f);
+}
+
+void EchoCanceller::reset() {
+    std::fill(weights_.begin(), weights_.end(), 0.0f);
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    std::fill(block_peaks_.begin(), block_peaks_.end(), 0.0f);
+    pos_ = 0;
+    energy_ = 0.0;
+    block_index_ = 0;
+    block_fill_ = 0;
+    current_peak_ = 0.0f;
+    window_peak_ = 0.0f;
+    hold_remaining_ = 0;
+}
+
+void EchoCanceller::process(const float* mic, const float* reference, float* out, size_t n) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = filter_sample(reference[i], mic[i]);
+    }
+    samples_ += n;
+    cpu_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+float EchoCanceller::filter_sample(float reference, float mic) {
+    // 新的参考采样写入窗口头部，挤出最老的一个
+    pos_ = pos_ == 0 ? taps_ - 1 : pos_ - 1;
+    float oldest = history_[pos_];
+    history_[pos_] = reference;
+    history_[pos_ + taps_] = reference;
+    energy_ = std::max(0.0, energy_ + static_cast<double>(reference) * reference -
+                                static_cast<double>(oldest) * oldest);
+
+    current_peak_ = std::max(current_peak_, std::fabs(reference));
+    if (++block_fill_ == kPeakBlock) {
+        block_peaks_[block_index_] = current_peak_;
+        block_index_ = (block_index_ + 1) % block_peaks_.size();
+        window_peak_ = *std::max_element(block_peaks_.begin(), block_peaks_.end());
+        current_peak_ = 0.0f;
+        block_fill_ = 0;
+    }
+
+    // 窗口内没有参考信号 (TTS 未播放)：没有回声可消除，也不更新滤波器
+    if (energy_ < taps_ * 1e-10) {
+        return mic;
+    }
+
+    const float* x = &history_[pos_];
+    const float* w = weights_.data();
+    // 8 路独立累加，不依赖 -ffast-math 也能向量化
+    float acc[8] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    for (size_t k = 0; k < taps_; k += 8) {
+        for (size_t j = 0; j < 8; ++j) {
+            acc[j] += w[k + j] * x[k + j];
+        }
+    }
+    float echo = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+    float error = mic - echo;
+    if (!std::isfinite(error)) {
+        std::cerr << "[AEC] 滤波器发散，已重置" << std::endl;
+        reset();
+        return mic;
+    }
+
+    ++echo_samples_;
+    float peak = std::max(window_peak_, current_peak_);
+    if (std::fabs(mic) > options_.double_talk_threshold * peak) {
+        hold_remaining_ = hold_samples_;
+    }
+    if (hold_remaining_ > 0) {
+        --hold_remaining_;
+        ++double_talk_samples_;
+        return error;
+    }
+
+    echo_mic_energy_ += static_cast<double>(mic) * mic;
+    echo_out_energy_ += static_cast<double>(error) * error;
+    float gain = options_.step_size * error / static_cast<float>(energy_ + taps_ * 1e-6);
+    float* wm = weights_.data();
+    for (size_t k = 0; k < taps_; ++k) {
+        wm[k] += gain * x[k];
+    }
+    return error;
+}
+
+void EchoCanceller::print_stats() const {
+    if (samples_ == 0) {
+        return;
+    }
+    double audio_seconds = static_cast<double>(samples_) / sample_rate_;
+    std::cout << "[AEC] 滤波器 " << taps_ << " 阶 (" << taps_ * 1000 / sample_rate_ << " ms)，有回声的音频 "
+              << static_cast<double>(echo_samples_) / sample_rate_ << " 秒，其中双讲 "
+              << static_cast<double>(double_talk_samples_) / sample_rate_ << " 秒";
+    if (echo_out_energy_ > 0.0) {
+        std::cout << "，回声衰减 (ERLE) " << 10.0 * std::log10(echo_mic_energy_ / echo_out_energy_) << " dB";
+    }
+    std::cout << "，耗时占音频时长 " << 100.0 * cpu_seconds_ / audio_seconds << "%" << std::endl;
+}
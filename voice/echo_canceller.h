@@ -0,0 +1,67 @@
+// echo_canceller.h
+// 声学回声消除：以 TTS 实际播放的信号为参考，用 NLMS 自适应滤波器估计扬声器到麦克风的回声路径，
+// 从麦克风信号中减去估计的回声，使 VAD/ASR 在助手说话时也能听到用户。
+// 双讲 (用户与 TTS 同时发声) 时用 Geigel 检测冻结滤波器更新，避免用户的声音被当成回声学掉；
+// Geigel 假定回声比参考信号至少低 6dB，扬声器离麦克风很近时需调高 double_talk_threshold。
+#ifndef ECHO_CANCELLER_H
+#define ECHO_CANCELLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct EchoCancellerOptions {
+    bool enabled = false;
+    float filter_ms = 128.0f;           // 可建模的回声路径长度 (超出 delay_ms 的部分)
+    float step_size = 0.2f;             // NLMS 归一化步长 (0, 1]，越大收敛越快、稳态误差越大
+    float delay_ms = 0.0f;              // 参考信号的固定延迟：播放缓冲、声学传播及两端时钟的固定偏差
+    float double_talk_threshold = 0.5f; // Geigel 检测：麦克风幅度超过参考近期峰值的该倍数即视为双讲
+    float double_talk_hold_ms = 100.0f; // 双讲判定后继续冻结更新的时长
+};
+
+// 非线程安全，在处理线程中使用
+class EchoCanceller {
+public:
+    EchoCanceller(const EchoCancellerOptions& options, int sample_rate);
+
+    // mic 与 reference 为同一时段的 n 个采样，消除回声后写入 out (可与 mic 相同)
+    void process(const float* mic, const float* reference, float* out, size_t n);
+    void reset();
+
+    size_t taps() const { return taps_; }
+    void print_stats() const;
+
+private:
+    float filter_sample(float reference, float mic);
+
+    EchoCancellerOptions options_;
+    int sample_rate_;
+    size_t taps_;
+
+    std::vector<float> weights_;
+    // 参考信号历史写两份 (pos 与 pos + taps)，任意时刻最近 taps 个采样在内存中连续，
+    // 点积与权值更新都是连续数组上的循环，可由编译器向量化
+    std::vector<float> history_;
+    size_t pos_ = 0;
+    double energy_ = 0.0;               // 窗口内参考信号能量
+
+    // Geigel 检测需要参考信号在滤波器窗口内的峰值：按块记录峰值，块满时重算
+    static constexpr size_t kPeakBlock = 64;
+    std::vector<float> block_peaks_;
+    size_t block_index_ = 0;
+    size_t block_fill_ = 0;
+    float current_peak_ = 0.0f;
+    float window_peak_ = 0.0f;
+    size_t hold_samples_;
+    size_t hold_remaining_ = 0;
+
+    // 统计
+    uint64_t samples_ = 0;
+    uint64_t echo_samples_ = 0;         // 参考信号非零的采样
+    uint64_t double_talk_samples_ = 0;
+    double echo_mic_energy_ = 0.0;      // 只有回声 (非双讲) 时麦克风与输出的能量，用于估计回声衰减 (ERLE)
+    double echo_out_energy_ = 0.0;
+    double cpu_seconds_ = 0.0;
+};
+
+#endif // ECHO_CANCELLER_H
@@ -0,0 +1,146 @@
+// echo_reference.cpp
+// 回声消除参考信号的接收、重采样与按时间对齐
+
+#include "echo_reference.h"
+#include "sys_util.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// 相邻两段播放的起始时刻误差在此范围内即视为连续，避免时间戳抖动在参考信号中留下缺口或重叠
+constexpr int64_t kSnapMs = 5;
+
+} // namespace
+
+std::string encode_pcm_message(const int16_t* samples, size_t n, int sample_rate, int64_t play_start_us) {
+    PcmFrameHeader header;
+    header.format = static_cast<uint16_t>(PcmFormat::Int16);
+    header.sample_rate = static_cast<uint32_t>(sample_rate);
+    header.capture_time_us = play_start_us;
+    std::string payload(sizeof(header) + n * sizeof(int16_t), '\0');
+    std::memcpy(&payload[0], &header, sizeof(header));
+    std::memcpy(&payload[sizeof(header)], samples, n * sizeof(int16_t));
+    return payload;
+}
+
+EchoReference::EchoReference(int sample_rate, float history_seconds)
+    : sample_rate_(sample_rate),
+      ring_(std::max<size_t>(1, static_cast<size_t>(history_seconds * sample_rate)), 0.0f)
+{
+}
+
+int64_t EchoReference::to_index(int64_t us) const {
+    // 先拆成整秒，避免乘法溢出
+    return us / 1000000 * sample_rate_ + (us % 1000000) * sample_rate_ / 1000000;
+}
+
+bool EchoReference::push_message(const std::string& payload) {
+    PcmFrameHeader header;
+    if (payload.size() < sizeof(header)) {
+        ++rejected_;
+        return false;
+    }
+    std::memcpy(&header, payload.data(), sizeof(header));
+    const char* data = payload.data() + sizeof(header);
+    size_t bytes = payload.size() - sizeof(header);
+    const bool is_float = header.format == static_cast<uint16_t>(PcmFormat::Float32);
+    const size_t sample_bytes = is_float ? sizeof(float) : sizeof(int16_t);
+    if (header.magic != kPcmFrameMagic || header.version != kPcmFrameVersion || header.sample_rate == 0 ||
+        (!is_float && header.format != static_cast<uint16_t>(PcmFormat::Int16)) || bytes % sample_bytes != 0) {
+        ++rejected_;
+        return false;
+    }
+    size_t n = bytes / sample_bytes;
+    std::vector<float> samples(n);
+    if (is_float) {
+        std::memcpy(samples.data(), data, bytes);
+    } else {
+        std::vector<int16_t> pcm(n);
+        std::memcpy(pcm.data(), data, bytes);
+        for (size_t i = 0; i < n; ++i) {
+            samples[i] = pcm[i] / 32768.0f;
+        }
+    }
+    push(samples.data(), n, static_cast<int>(header.sample_rate), header.capture_time_us);
+    return true;
+}
+
+void EchoReference::push(const float* samples, size_t n, int sample_rate, int64_t play_start_us) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (sample_rate != sample_rate_) {
+        // TTS 的采样率一般与麦克风不同，线性插值足以作为回声消除的参考
+        size_t out_n = static_cast<size_t>(static_cast<double>(n) * sample_rate_ / sample_rate);
+        resampled_.resize(out_n);
+        double step = static_cast<double>(sample_rate) / sample_rate_;
+        for (size_t i = 0; i < out_n; ++i) {
+            double pos = i * step;
+            size_t j = static_cast<size_t>(pos);
+            float frac = static_cast<float>(pos - j);
+            float next = j + 1 < n ? samples[j + 1] : samples[j];
+            resampled_[i] = samples[j] + (next - samples[j]) * frac;
+        }
+        samples = resampled_.data();
+        n = out_n;
+    }
+    if (n == 0) {
+        return;
+    }
+    ++messages_;
+
+    const int64_t capacity = static_cast<int64_t>(ring_.size());
+    int64_t index = to_index(play_start_us);
+    if (end_ > begin_ && std::llabs(index - end_) <= kSnapMs * sample_rate_ / 1000) {
+        index = end_;
+    }
+    if (end_ == begin_ || index - end_ >= capacity || index + static_cast<int64_t>(n) <= end_ - capacity) {
+        begin_ = end_ = index;
+    }
+    if (index < read_end_) {
+        late_samples_ += static_cast<uint64_t>(std::min<int64_t>(read_end_ - index, static_cast<int64_t>(n)));
+    }
+    // 与上一段之间的空隙填 0
+    for (int64_t i = end_; i < index; ++i) {
+        ring_[i % capacity] = 0.0f;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        ring_[(index + static_cast<int64_t>(i)) % capacity] = samples[i];
+    }
+    end_ = std::max(end_, index + static_cast<int64_t>(n));
+    begin_ = std::max(std::min(begin_, index), end_ - capacity);
+}
+
+void EchoReference::read(int64_t start_us, float* out, size_t n) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const int64_t capacity = static_cast<int64_t>(ring_.size());
+    int64_t index = to_index(start_us);
+    for (size_t i = 0; i < n; ++i) {
+        int64_t j = index + static_cast<int64_t>(i);
+        out[i] = j >= begin_ && j < end_ ? ring_[j % capacity] : 0.0f;
+    }
+    read_end_ = std::max(read_end_, index + static_cast<int64_t>(n));
+}
+
+void EchoReference::print_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::cout << "[AEC] 收到参考信号 " << messages_ << " 段，格式错误 " << rejected_
+              << " 段，晚于麦克风处理到达 " << late_samples_ * 1000 / sample_rate_ << " ms" << std::endl;
+}
+
+int64_t CaptureClock::stamp(size_t n) {
+    const int64_t now = now_us();
+    samples_ += n;
+    // 刚读到的采样最晚在此刻采集完毕；处理延迟只会让估计的起点偏晚
+    int64_t origin = now - static_cast<int64_t>(samples_ * 1000000 / sample_rate_);
+    if (samples_ == n) {
+        origin_us_ = origin;
+    } else {
+        // 允许起点每帧推后 100ppm 的帧长，跟随时钟漂移
+        int64_t drift = static_cast<int64_t>(n * 100 / sample_rate_);
+        origin_us_ = std::min(origin_us_ + drift, origin);
+    }
+    return origin_us_ + static_cast<int64_t>((samples_ - n) * 1000000 / sample_rate_);
+}
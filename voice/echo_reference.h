@@ -0,0 +1,71 @@
+// echo_reference.h
+// 回声消除的参考信号：TTS 服务把实际播放的 PCM 连同播放时刻发布出来 (ZMQ PUB)，
+// 识别端按墙上时钟对齐到麦克风采样，作为回声消除器的远端输入。
+// 每条消息为两帧: [主题 "TTS::PCM"][PcmFrameHeader + 单声道 PCM]，帧头与远程采集协议相同 (见 pcm_ingest.h)，
+// 其中 capture_time_us 为第一个采样从扬声器播出的时刻；sequence 与 flags 未使用。
+// 跨主机时两端需用 NTP/chrony 同步时钟，剩余的固定偏差由 --aec-delay 补偿。
+#ifndef ECHO_REFERENCE_H
+#define ECHO_REFERENCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "pcm_ingest.h"
+
+constexpr const char* kPcmTopic = "TTS::PCM";
+
+// 打包一段播放中的 PCM (TTS 端使用)
+std::string encode_pcm_message(const int16_t* samples, size_t n, int sample_rate, int64_t play_start_us);
+
+// 按时间排列的参考信号缓冲区。push 由接收线程调用，read 由处理线程调用，线程安全。
+// 内部统一重采样到麦克风的采样率；没有参考信号的时间段读出为 0。
+class EchoReference {
+public:
+    EchoReference(int sample_rate, float history_seconds = 2.0f);
+
+    // 解析一条 TTS::PCM 载荷，格式错误时返回 false
+    bool push_message(const std::string& payload);
+    void push(const float* samples, size_t n, int sample_rate, int64_t play_start_us);
+
+    // 取出 [start_us, start_us + n 个采样) 时间段内播放的参考信号
+    void read(int64_t start_us, float* out, size_t n);
+
+    int sample_rate() const { return sample_rate_; }
+    void print_stats() const;
+
+private:
+    int64_t to_index(int64_t us) const;
+
+    int sample_rate_;
+    mutable std::mutex mutex_;
+    std::vector<float> ring_;       // 按绝对采样序号 (墙上时钟 × 采样率) 取模存放
+    int64_t begin_ = 0;             // 缓冲区内有效数据的采样序号范围 [begin_, end_)
+    int64_t end_ = 0;
+    std::vector<float> resampled_;
+
+    int64_t read_end_ = 0;          // 处理线程已读到的位置
+
+    uint64_t messages_ = 0;
+    uint64_t rejected_ = 0;
+    uint64_t late_samples_ = 0;     // 到达时麦克风已处理过对应时段的采样数 (这部分回声无法消除)
+};
+
+// 麦克风采样的墙上时钟：以第一帧为起点按采样数推算，取所有估计中最早的一个，
+// 排除处理延迟造成的抖动，并缓慢放宽以跟随声卡与系统时钟之间的漂移。非线程安全。
+class CaptureClock {
+public:
+    explicit CaptureClock(int sample_rate) : sample_rate_(sample_rate) {}
+
+    // 刚读到 n 个采样时调用，返回这 n 个采样中第一个的采集时刻 (system_clock 微秒)
+    int64_t stamp(size_t n);
+    void reset() { samples_ = 0; }
+
+private:
+    int sample_rate_;
+    uint64_t samples_ = 0;
+    int64_t origin_us_ = 0;         // 第 0 个采样的采集时刻
+};
+
+#endif // ECHO_REFERENCE_H
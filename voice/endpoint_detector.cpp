@@ -0,0 +1,106 @@
+// endpoint_detector.cpp
+// 自适应端点检测
+
+#include "endpoint_detector.h"
+#include "vad_gate.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+// 句末出现这些词时说话人多半还要继续说 (识别结果中英文为大写)
+const char* const kContinuationWords[] = {
+    "的", "和", "跟", "与", "把", "给", "还有", "然后", "而且", "但是", "因为", "所以",
+    "如果", "或者", "就是", "那个", "这个", "AND", "THE", "TO", "OF", "OR", "BUT", "WITH", "FOR",
+};
+
+bool ends_with_continuation(const std::string& text) {
+    size_t end = text.size();
+    while (end > 0 && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+        --end;
+    }
+    for (const char* word : kContinuationWords) {
+        std::string w(word);
+        if (end < w.size() || text.compare(end - w.size(), w.size(), w) != 0) {
+            continue;
+        }
+        // 英文词需要整词匹配，避免 "INTO" 匹配到 "TO"
+        bool ascii = std::isalpha(static_cast<unsigned char>(w[0]));
+        size_t start = end - w.size();
+        if (!ascii || start == 0 || !std::isalpha(static_cast<unsigned char>(text[start - 1]))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+const char* endpoint_reason_name(EndpointReason reason) {
+    switch (reason) {
+        case EndpointReason::Adaptive: return "自适应";
+        case EndpointReason::Recognizer: return "识别器规则";
+        case EndpointReason::Vad: return "VAD静音";
+        case EndpointReason::None: break;
+    }
+    return "无";
+}
+
+EndpointDetector::EndpointDetector(int sample_rate, const EndpointOptions& options)
+    : sample_rate_(sample_rate),
+      options_(options),
+      subframe_(static_cast<size_t>(sample_rate / 100))
+{
+}
+
+void EndpointDetector::start() {
+    speech_samples_ = 0;
+    trailing_silence_ = 0;
+    voiced_run_ = 0;
+    since_text_change_ = 0;
+    text_.clear();
+    continuation_ = false;
+}
+
+void EndpointDetector::observe(const float* samples, size_t n, float noise_floor_db) {
+    for (size_t offset = 0; offset < n; offset += subframe_) {
+        size_t len = std::min(subframe_, n - offset);
+        FrameFeatures features = compute_frame_features(samples + offset, len, len);
+        if (features.max_energy_db - noise_floor_db > options_.margin_db) {
+            // 句中停顿也计入语音时长
+            speech_samples_ += trailing_silence_ + len;
+            trailing_silence_ = 0;
+            voiced_run_ += len;
+        } else {
+            trailing_silence_ += len;
+            voiced_run_ = 0;
+        }
+    }
+    since_text_change_ += n;
+}
+
+void EndpointDetector::update_text(const std::string& text) {
+    if (text != text_) {
+        text_ = text;
+        since_text_change_ = 0;
+        continuation_ = ends_with_continuation(text_);
+    }
+}
+
+double EndpointDetector::required_silence_ms() const {
+    if (continuation_) {
+        return options_.max_silence_ms;
+    }
+    double extra_seconds = std::max(0.0, static_cast<double>(speech_samples_) / sample_rate_ -
+                                             options_.short_speech_seconds);
+    return std::min<double>(options_.max_silence_ms,
+                            options_.min_silence_ms + options_.silence_per_second_ms * extra_seconds);
+}
+
+bool EndpointDetector::should_finalize() const {
+    // 还没有识别出文字时交给 VAD 判断 (可能只是噪声)
+    if (text_.empty()) {
+        return false;
+    }
+    return trailing_silence_ms() >= required_silence_ms() && to_ms(since_text_change_) >= options_.min_stable_ms;
+}
@@ -0,0 +1,64 @@
+// endpoint_detector.h
+// 自适应端点检测：流式识别期间按 10ms 子帧跟踪尾部静音，并结合识别文本是否已稳定、
+// 语音时长和末尾词决定一句话是否结束。短而完整的指令在 150~250ms 静音后即可结束，
+// 长句口述或以"然后""的"等连接词结尾时要求更长的静音，允许句中停顿。
+// 固定的 VAD 静音时长 (及识别器自带的端点规则) 作为上限保留。非线程安全。
+#ifndef ENDPOINT_DETECTOR_H
+#define ENDPOINT_DETECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct EndpointOptions {
+    bool enabled = false;
+    float min_silence_ms = 150.0f;          // 短句且文本已稳定时要求的尾部静音
+    float short_speech_seconds = 1.5f;      // 不超过此时长的语音视为短指令，只要求 min_silence_ms
+    float silence_per_second_ms = 150.0f;   // 超出部分每多一秒语音，要求的尾部静音增加多少
+    float max_silence_ms = 1000.0f;         // 上限，同时用作 VAD 静音时长和识别器端点规则
+    float min_stable_ms = 150.0f;           // 识别文本至少这么久没有变化
+    float margin_db = 6.0f;                 // 子帧能量高于噪声基底多少 dB 视为有声
+    float reonset_ms = 150.0f;              // 提前结束后 VAD 尚未放开时，连续有声多久视为新的一句
+};
+
+enum class EndpointReason {
+    None,
+    Adaptive,       // 尾部静音达到按语音时长/文本计算的要求
+    Recognizer,     // 识别器自带的端点规则
+    Vad,            // VAD 静音时长 (上限)
+};
+
+const char* endpoint_reason_name(EndpointReason reason);
+
+class EndpointDetector {
+public:
+    EndpointDetector(int sample_rate, const EndpointOptions& options = EndpointOptions());
+
+    // 一句话开始时调用，清空静音与文本状态
+    void start();
+    // 送入一帧音频，noise_floor_db 为当前的噪声基底
+    void observe(const float* samples, size_t n, float noise_floor_db);
+    // 每帧解码后送入当前识别文本，用于判断文本是否已稳定
+    void update_text(const std::string& text);
+
+    bool should_finalize() const;
+    double trailing_silence_ms() const { return to_ms(trailing_silence_); }
+    double voiced_run_ms() const { return to_ms(voiced_run_); }
+    double required_silence_ms() const;
+
+private:
+    double to_ms(uint64_t samples) const { return samples * 1000.0 / sample_rate_; }
+
+    int sample_rate_;
+    EndpointOptions options_;
+    size_t subframe_;
+
+    uint64_t speech_samples_ = 0;       // 一句话开始以来的有声时长 (不含尾部静音)
+    uint64_t trailing_silence_ = 0;
+    uint64_t voiced_run_ = 0;
+    uint64_t since_text_change_ = 0;
+    std::string text_;
+    bool continuation_ = false;         // 文本以连接词结尾，说话人多半还没说完
+};
+
+#endif // ENDPOINT_DETECTOR_H
@@ -0,0 +1,92 @@
+// event_reactor.cpp
+// 基于 zmq::poll 的单线程事件循环
+
+#include "event_reactor.h"
+#include <cstdint>
+#include <iostream>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+EventReactor::EventReactor() {
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ >= 0) {
+        add_fd(wake_fd_, [this] {
+            uint64_t value;
+            while (::read(wake_fd_, &value, sizeof(value)) == sizeof(value)) {
+            }
+        });
+    }
+}
+
+EventReactor::~EventReactor() {
+    if (wake_fd_ >= 0) {
+        ::close(wake_fd_);
+    }
+    if (signal_fd_ >= 0) {
+        ::close(signal_fd_);
+    }
+}
+
+void EventReactor::add_socket(zmq::socket_t& socket, Handler handler) {
+    items_.push_back({socket.handle(), 0, ZMQ_POLLIN, 0});
+    handlers_.push_back(std::move(handler));
+}
+
+void EventReactor::add_fd(int fd, Handler handler) {
+    items_.push_back({nullptr, fd, ZMQ_POLLIN, 0});
+    handlers_.push_back(std::move(handler));
+}
+
+bool EventReactor::add_signals(const std::vector<int>& signals, std::function<void(int)> handler) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    for (int signo : signals) {
+        sigaddset(&mask, signo);
+    }
+    if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0) {
+        return false;
+    }
+    signal_fd_ = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd_ < 0) {
+        pthread_sigmask(SIG_UNBLOCK, &mask, nullptr);
+        return false;
+    }
+    add_fd(signal_fd_, [this, handler = std::move(handler)] {
+        signalfd_siginfo info;
+        while (::read(signal_fd_, &info, sizeof(info)) == sizeof(info)) {
+            handler(static_cast<int>(info.ssi_signo));
+        }
+    });
+    return true;
+}
+
+void EventReactor::run() {
+    while (!stopped_) {
+        try {
+            zmq::poll(items_.data(), items_.size(), std::chrono::milliseconds(-1));
+        } catch (const zmq::error_t& e) {
+            if (e.num() == EINTR) {
+                continue;
+            }
+            std::cerr << "[Reactor] 等待事件失败: " << e.what() << std::endl;
+            break;
+        }
+        // 处理函数可能调用 stop()，本轮已就绪的事件仍全部处理完
+        for (size_t i = 0; i < items_.size(); ++i) {
+            if (items_[i].revents & ZMQ_POLLIN) {
+                handlers_[i]();
+            }
+        }
+    }
+}
+
+void EventReactor::stop() {
+    stopped_ = true;
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t written = ::write(wake_fd_, &one, sizeof(one));
+        (void)written;
+    }
+}
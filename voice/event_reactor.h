@@ -0,0 +1,44 @@
+// event_reactor.h
+// 单线程事件循环：基于 zmq::poll 同时等待 ZMQ 套接字与普通文件描述符
+// (采集就绪 eventfd、signalfd 等)，就绪后立即在本线程调用对应的处理函数。
+// 取代“非阻塞尝试 + sleep”的轮询方式，空闲时不产生唤醒，事件到达即处理。
+#ifndef EVENT_REACTOR_H
+#define EVENT_REACTOR_H
+
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <zmq.hpp>
+
+class EventReactor {
+public:
+    using Handler = std::function<void()>;
+
+    EventReactor();
+    ~EventReactor();
+
+    EventReactor(const EventReactor&) = delete;
+    EventReactor& operator=(const EventReactor&) = delete;
+
+    // 套接字可读时调用 handler (handler 应读空所有已到达的消息)
+    void add_socket(zmq::socket_t& socket, Handler handler);
+    // 文件描述符可读时调用 handler (水平触发，handler 需把 fd 读到不可读为止)
+    void add_fd(int fd, Handler handler);
+    // 屏蔽这些信号并通过 signalfd 在事件循环中处理。
+    // 须在创建任何其他线程之前调用，使所有线程继承信号屏蔽字。
+    bool add_signals(const std::vector<int>& signals, std::function<void(int)> handler);
+
+    // 运行直到 stop() 被调用
+    void run();
+    // 线程安全，可在处理函数或其他线程中调用
+    void stop();
+
+private:
+    std::vector<zmq::pollitem_t> items_;
+    std::vector<Handler> handlers_;
+    int wake_fd_ = -1;
+    int signal_fd_ = -1;
+    std::atomic<bool> stopped_{false};
+};
+
+#endif // EVENT_REACTOR_H
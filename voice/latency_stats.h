@@ -0,0 +1,133 @@
+// latency_stats.h
+// 简单的延迟/耗时分布统计：记录每个样本，按需计算均值与分位数。
+// LatencyHistogram 只保存固定数量的对数分桶，内存不随样本数增长，用于长期运行的服务端。
+// 非线程安全，调用方需保证只在单一线程中使用。
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+class LatencyStats {
+public:
+    explicit LatencyStats(std::string name) : name_(std::move(name)) {}
+
+    void add(double ms) { samples_.push_back(ms); }
+    void clear() { samples_.clear(); }
+    size_t count() const { return samples_.size(); }
+    const std::string& name() const { return name_; }
+
+    double mean() const {
+        if (samples_.empty()) return 0.0;
+        return std::accumulate(samples_.begin(), samples_.end(), 0.0) / samples_.size();
+    }
+
+    // p 取值 [0, 100]，采用最近秩法
+    double percentile(double p) const {
+        if (samples_.empty()) return 0.0;
+        std::vector<double> sorted(samples_);
+        std::sort(sorted.begin(), sorted.end());
+        size_t rank = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(rank, sorted.size() - 1)];
+    }
+
+    void print(std::ostream& os = std::cout) const {
+        if (samples_.empty()) {
+            os << "[Stats] " << name_ << ": 无数据" << std::endl;
+            return;
+        }
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "n=%zu mean=%.1fms p50=%.1fms p90=%.1fms p99=%.1fms max=%.1fms",
+                      samples_.size(), mean(), percentile(50), percentile(90), percentile(99),
+                      percentile(100));
+        os << "[Stats] " << name_ << ": " << line << std::endl;
+    }
+
+private:
+    std::string name_;
+    std::vector<double> samples_;
+};
+
+// 每个 2 倍区间分 16 桶 (相对误差约 2%)，覆盖 0.01ms ~ 约 168 秒；max 精确记录
+class LatencyHistogram {
+public:
+    explicit LatencyHistogram(std::string name) : name_(std::move(name)) {}
+
+    void add(double ms) {
+        ++buckets_[bucket(ms)];
+        ++count_;
+        sum_ += ms;
+        max_ = std::max(max_, ms);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            buckets_[i] += other.buckets_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    size_t count() const { return count_; }
+    const std::string& name() const { return name_; }
+    double mean() const { return count_ ? sum_ / count_ : 0.0; }
+
+    // p 取值 [0, 100]，与 LatencyStats 相同的最近秩法，返回所在桶的几何中点
+    double percentile(double p) const {
+        if (count_ == 0) return 0.0;
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * (count_ - 1) + 0.5);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += buckets_[i];
+            if (seen > rank) {
+                return std::min(bucket_value(i), max_);
+            }
+        }
+        return max_;
+    }
+
+    void print(std::ostream& os = std::cout) const {
+        if (count_ == 0) {
+            os << "[Stats] " << name_ << ": 无数据" << std::endl;
+            return;
+        }
+        char line[256];
+        std::snprintf(line, sizeof(line),
+                      "n=%llu mean=%.1fms p50=%.1fms p90=%.1fms p99=%.1fms max=%.1fms",
+                      static_cast<unsigned long long>(count_), mean(), percentile(50), percentile(90),
+                      percentile(99), max_);
+        os << "[Stats] " << name_ << ": " << line << std::endl;
+    }
+
+private:
+    static constexpr int kBucketsPerOctave = 16;
+    static constexpr size_t kBuckets = 24 * kBucketsPerOctave + 1;
+    static constexpr double kMinMs = 0.01;
+
+    static size_t bucket(double ms) {
+        if (!(ms > kMinMs)) return 0;
+        double b = std::log2(ms / kMinMs) * kBucketsPerOctave + 1.0;
+        return std::min(static_cast<size_t>(b), kBuckets - 1);
+    }
+
+    static double bucket_value(size_t i) {
+        return i == 0 ? kMinMs : kMinMs * std::exp2((i - 0.5) / kBucketsPerOctave);
+    }
+
+    std::string name_;
+    std::array<uint64_t, kBuckets> buckets_{};
+    uint64_t count_ = 0;
+    double sum_ = 0.0;
+    double max_ = 0.0;
+};
+
+#endif // LATENCY_STATS_H
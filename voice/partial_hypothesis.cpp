@@ -0,0 +1,118 @@
+// partial_hypothesis.cpp
+// 中间识别结果的差量编码与还原
+
+#include "partial_hypothesis.h"
+#include "sys_util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// 公共前缀长度，退回到 UTF-8 字符边界，避免把一个汉字拆成两半
+size_t common_prefix(const std::string& a, const std::string& b) {
+    size_t n = std::min(a.size(), b.size());
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) {
+        ++i;
+    }
+    while (i > 0 && i < a.size() && (static_cast<unsigned char>(a[i]) & 0xC0) == 0x80) {
+        --i;
+    }
+    return i;
+}
+
+} // namespace
+
+HypothesisEncoder::HypothesisEncoder(size_t stable_updates)
+    : stable_updates_(std::max<size_t>(1, stable_updates))
+{
+}
+
+std::string HypothesisEncoder::encode(const HypothesisUpdate& update) {
+    HypothesisHeader header;
+    if (update.utterance_id != utterance_id_) {
+        utterance_id_ = update.utterance_id;
+        sequence_ = 0;
+        text_.clear();
+        history_.clear();
+    }
+
+    size_t keep = 0;
+    size_t stable = 0;
+    if (update.final) {
+        header.flags |= kHypFlagFinal;
+        stable = update.text.size();
+    } else {
+        keep = sequence_ == 0 ? 0 : common_prefix(text_, update.text);
+        // 稳定前缀：与最近 stable_updates 次结果都相同的部分
+        if (history_.size() >= stable_updates_) {
+            stable = update.text.size();
+            for (const auto& previous : history_) {
+                stable = std::min(stable, common_prefix(update.text, previous));
+            }
+        }
+        history_.push_back(update.text);
+        if (history_.size() > stable_updates_) {
+            history_.pop_front();
+        }
+    }
+
+    header.utterance_id = update.utterance_id;
+    header.sequence = sequence_++;
+    header.keep_bytes = static_cast<uint32_t>(keep);
+    header.stable_bytes = static_cast<uint32_t>(stable);
+    header.audio_ms = update.audio_ms;
+    header.utterance_start_us = update.utterance_start_us;
+    header.timestamp_us = now_us();
+    text_ = update.text;
+
+    std::string payload(sizeof(header) + update.text.size() - keep, '\0');
+    std::memcpy(&payload[0], &header, sizeof(header));
+    std::memcpy(&payload[sizeof(header)], update.text.data() + keep, update.text.size() - keep);
+
+    ++messages_;
+    payload_bytes_ += payload.size() - sizeof(header);
+    full_text_bytes_ += update.text.size();
+    return payload;
+}
+
+void HypothesisEncoder::print_stats(std::ostream& os) const {
+    if (messages_ == 0) {
+        return;
+    }
+    os << "[Partial] 发布识别结果 " << messages_ << " 条，差量文本共 " << payload_bytes_
+       << " 字节 (每次发送全文需 " << full_text_bytes_ << " 字节)" << std::endl;
+}
+
+bool HypothesisDecoder::apply(const void* data, size_t size, HypothesisHeader& header, std::string& text) {
+    if (size < sizeof(HypothesisHeader)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kHypMagic || header.version != kHypVersion) {
+        return false;
+    }
+    const char* suffix = static_cast<const char*>(data) + sizeof(header);
+    size_t suffix_size = size - sizeof(header);
+
+    if (header.utterance_id != utterance_id_) {
+        utterance_id_ = header.utterance_id;
+        valid_ = header.sequence == 0;
+    } else if (header.sequence != next_sequence_) {
+        valid_ = false;
+    }
+    next_sequence_ = header.sequence + 1;
+    if ((header.flags & kHypFlagFinal) || header.keep_bytes == 0) {
+        // 最终结果及每句的第一条都是全文
+        valid_ = true;
+    }
+    if (!valid_ || header.keep_bytes > text_.size()) {
+        valid_ = false;
+        return false;
+    }
+    text_.resize(header.keep_bytes);
+    text_.append(suffix, suffix_size);
+    text = text_;
+    return true;
+}
@@ -0,0 +1,80 @@
+// partial_hypothesis.h
+// 中间识别结果发布协议：识别端 (ZMQ PUB) → 界面/下游服务 (ZMQ SUB)。
+// 每次更新是一条两帧的 ZMQ 消息: [主题 "ASR::HYP"][HypothesisHeader + UTF-8 文本]
+// 文本以差量方式传输：保留上一条结果的前 keep_bytes 字节，其后替换为本消息附带的文本。
+// 每句话的第一条和最终结果 (kHypFlagFinal) 总是携带全文 (keep_bytes 为 0)，
+// 订阅方发现 sequence 不连续 (PUB 在高水位时会丢消息) 时丢弃本句，等待最终结果即可恢复。
+// 字节序为小端。
+#ifndef PARTIAL_HYPOTHESIS_H
+#define PARTIAL_HYPOTHESIS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <string>
+
+constexpr const char* kHypothesisTopic = "ASR::HYP";
+constexpr uint32_t kHypMagic = 0x50594856;        // "VHYP"
+constexpr uint16_t kHypVersion = 1;
+constexpr uint16_t kHypFlagFinal = 1u << 0;
+
+struct HypothesisHeader {
+    uint32_t magic = kHypMagic;
+    uint16_t version = kHypVersion;
+    uint16_t flags = 0;
+    uint64_t utterance_id = 0;      // 每次运行从 1 开始递增
+    uint32_t sequence = 0;          // 本句内从 0 开始递增，用于发现丢失
+    uint32_t keep_bytes = 0;        // 保留上一条文本的前缀字节数
+    uint32_t stable_bytes = 0;      // 文本 (应用差量之后) 的前 stable_bytes 字节已稳定，不会再被改写
+    uint32_t audio_ms = 0;          // 本结果对应的音频时长 (自语音开始)
+    int64_t utterance_start_us = 0; // 语音开始时刻 (system_clock 微秒)
+    int64_t timestamp_us = 0;       // 发布时刻 (system_clock 微秒)
+};
+
+static_assert(sizeof(HypothesisHeader) == 48, "HypothesisHeader 是线上格式，布局不能改变");
+
+// 识别端产生的一次结果更新
+struct HypothesisUpdate {
+    uint64_t utterance_id = 0;
+    std::string text;
+    bool final = false;
+    uint32_t audio_ms = 0;
+    int64_t utterance_start_us = 0;
+};
+
+// 发布端：把完整文本编码为差量消息，并计算稳定前缀。非线程安全。
+class HypothesisEncoder {
+public:
+    // stable_updates: 前缀在最近多少次更新中都没有变化才算稳定
+    explicit HypothesisEncoder(size_t stable_updates = 2);
+
+    std::string encode(const HypothesisUpdate& update);
+    void print_stats(std::ostream& os = std::cout) const;
+
+private:
+    size_t stable_updates_;
+    uint64_t utterance_id_ = 0;
+    uint32_t sequence_ = 0;
+    std::string text_;
+    std::deque<std::string> history_;   // 本句最近几次的文本，用于计算稳定前缀
+
+    uint64_t messages_ = 0;
+    uint64_t payload_bytes_ = 0;
+    uint64_t full_text_bytes_ = 0;      // 若每次发送全文所需的文本字节数
+};
+
+// 订阅端：按差量还原文本。非线程安全。
+class HypothesisDecoder {
+public:
+    // 解析一条消息的载荷；格式错误或本句有消息丢失时返回 false (等待本句最终结果)
+    bool apply(const void* data, size_t size, HypothesisHeader& header, std::string& text);
+
+private:
+    uint64_t utterance_id_ = 0;
+    uint32_t next_sequence_ = 0;
+    bool valid_ = false;
+    std::string text_;
+};
+
+#endif // PARTIAL_HYPOTHESIS_H
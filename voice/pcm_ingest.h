@@ -0,0 +1,32 @@
+// pcm_ingest.h
+// 远程 PCM 采集协议：边缘设备 (ZMQ PUSH) → 识别主机 (ZMQ PULL)。
+// 每帧音频是一条三帧的 ZMQ 消息: [会话ID][PcmFrameHeader][采样数据]
+// 会话结束时发送带 kPcmFlagEnd 标志的帧 (采样数据可为空)。字节序为小端。
+#ifndef PCM_INGEST_H
+#define PCM_INGEST_H
+
+#include <cstdint>
+
+constexpr uint32_t kPcmFrameMagic = 0x4d435056;   // "VPCM"
+constexpr uint16_t kPcmFrameVersion = 1;
+constexpr uint32_t kPcmFlagEnd = 1u << 0;
+
+// 采样格式，取值与 WAV 格式码一致
+enum class PcmFormat : uint16_t {
+    Int16 = 1,
+    Float32 = 3
+};
+
+struct PcmFrameHeader {
+    uint32_t magic = kPcmFrameMagic;
+    uint16_t version = kPcmFrameVersion;
+    uint16_t format = static_cast<uint16_t>(PcmFormat::Int16);
+    uint32_t sample_rate = 16000;
+    uint32_t flags = 0;
+    uint64_t sequence = 0;          // 每个会话从 0 开始递增，用于发现丢帧
+    int64_t capture_time_us = 0;    // 本帧首个采样的采集时刻 (system_clock 微秒)，0 表示未知
+};
+
+static_assert(sizeof(PcmFrameHeader) == 32, "PcmFrameHeader 是线上格式，布局不能改变");
+
+#endif // PCM_INGEST_H
@@ -0,0 +1,202 @@
+// pcm_ingest_server.cpp
+// 网络 PCM 接入服务端：按会话 VAD 分段 + 共享识别器批量解码
+
+#include "pcm_ingest_server.h"
+#include "asr_model.h"
+#include "sys_util.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+using namespace sherpa_onnx::cxx;
+
+PcmIngestServer::PcmIngestServer(const BatchServerOptions& asr_options, const IngestOptions& options,
+                                 ResultCallback on_result)
+    : options_(options),
+      on_result_(std::move(on_result)),
+      asr_(asr_options, [this](AsrBatchServer::SessionId, const std::string& name, const std::string& text) {
+          if (on_result_) {
+              on_result_(name, text);
+          }
+      }),
+      puller_(options.address)
+{
+    std::cout << "[Ingest] 正在监听 " << options_.address << "，等待远程采集端..." << std::endl;
+}
+
+void PcmIngestServer::run(const std::atomic<bool>& running) {
+    std::vector<zmq::message_t> parts;
+    while (running) {
+        zmq::pollitem_t items[] = {{puller_.socket().handle(), 0, ZMQ_POLLIN, 0}};
+        try {
+            zmq::poll(items, 1, std::chrono::milliseconds(100));
+        } catch (const zmq::error_t& e) {
+            if (e.num() != EINTR) {
+                throw;
+            }
+            continue;
+        }
+
+        // 先取完已到达的帧 (每轮设上限，避免解码被饿死)，再对所有就绪的流批量解码
+        for (int i = 0; i < 256 && puller_.tryReceiveMultipart(parts); ++i) {
+            handle_frame(parts);
+        }
+        asr_.drain();
+        close_idle_sessions();
+    }
+
+    while (!sessions_.empty()) {
+        end_session(sessions_.begin(), "服务端退出");
+    }
+    while (asr_.session_count() > 0 && asr_.decode_ready() > 0) {
+    }
+}
+
+void PcmIngestServer::handle_frame(std::vector<zmq::message_t>& parts) {
+    ++frames_received_;
+    PcmFrameHeader header;
+    if (parts.size() != 3 || parts[1].size() != sizeof(header)) {
+        ++malformed_frames_;
+        return;
+    }
+    std::memcpy(&header, parts[1].data(), sizeof(header));
+    if (header.magic != kPcmFrameMagic || header.version != kPcmFrameVersion) {
+        ++malformed_frames_;
+        return;
+    }
+
+    const std::string key = parts[0].to_string();
+    auto it = sessions_.find(key);
+    Session& session = (it != sessions_.end()) ? it->second : open_session(key);
+    session.last_frame = std::chrono::steady_clock::now();
+    if (header.sequence > session.next_sequence) {
+        session.lost_frames += header.sequence - session.next_sequence;
+    }
+    session.next_sequence = header.sequence + 1;
+    ++session.frames;
+    if (header.capture_time_us > 0) {
+        session.transport_latency->add((now_us() - header.capture_time_us) / 1000.0);
+    }
+
+    const zmq::message_t& payload = parts[2];
+    if (header.sample_rate != static_cast<uint32_t>(asr_.sample_rate())) {
+        ++rejected_frames_;
+    } else if (header.format == static_cast<uint16_t>(PcmFormat::Int16)) {
+        const size_t n = payload.size() / sizeof(int16_t);
+        scratch_.resize(n);
+        const auto* in = static_cast<const uint8_t*>(payload.data());
+        for (size_t i = 0; i < n; ++i) {
+            int16_t v;
+            std::memcpy(&v, in + i * sizeof(v), sizeof(v));
+            scratch_[i] = v / 32768.0f;
+        }
+        feed(session, scratch_.data(), n);
+    } else if (header.format == static_cast<uint16_t>(PcmFormat::Float32)) {
+        // 消息缓冲区不保证按 float 对齐，拷贝一次
+        const size_t n = payload.size() / sizeof(float);
+        scratch_.resize(n);
+        std::memcpy(scratch_.data(), payload.data(), n * sizeof(float));
+        feed(session, scratch_.data(), n);
+    } else {
+        ++rejected_frames_;
+    }
+
+    if (header.flags & kPcmFlagEnd) {
+        end_session(sessions_.find(key), "采集端结束");
+    }
+}
+
+PcmIngestServer::Session& PcmIngestServer::open_session(const std::string& key) {
+    Session& session = sessions_[key];
+    session.asr_id = asr_.open_session(key);
+    session.vad = std::make_unique<VoiceActivityDetector>(
+        VoiceActivityDetector::Create(make_vad_config(options_.vad_model_path, asr_.sample_rate()), 30.0f));
+    session.gate = std::make_unique<VadGate>(asr_.sample_rate(), options_.vad_gate);
+    session.transport_latency = std::make_unique<LatencyHistogram>(key + " 采集→到达");
+    std::cout << "[Ingest] 新会话: " << key << " (当前 " << sessions_.size() << " 路)" << std::endl;
+    return session;
+}
+
+void PcmIngestServer::feed(Session& session, const float* samples, size_t n) {
+    session.samples += n;
+    VoiceActivityDetector& vad = *session.vad;
+    session.gate->process(samples, n, session.in_speech, [&vad](const float* s, size_t len) {
+        vad.AcceptWaveform(s, static_cast<int32_t>(len));
+    });
+    if (session.vad->IsDetected()) {
+        session.in_speech = true;
+    }
+    while (!session.vad->IsEmpty()) {
+        auto segment = session.vad->Front();
+        asr_.accept(session.asr_id, segment.samples.data(), segment.samples.size());
+        session.vad->Pop();
+    }
+    if (!session.vad->IsDetected() && session.in_speech) {
+        session.in_speech = false;
+        asr_.finish_utterance(session.asr_id);
+    }
+}
+
+void PcmIngestServer::end_session(std::unordered_map<std::string, Session>::iterator it, const char* reason) {
+    if (it == sessions_.end()) {
+        return;
+    }
+    Session& session = it->second;
+    // 冲刷 VAD 中尚未结束的语音段
+    session.vad->Flush();
+    while (!session.vad->IsEmpty()) {
+        auto segment = session.vad->Front();
+        asr_.accept(session.asr_id, segment.samples.data(), segment.samples.size());
+        session.vad->Pop();
+    }
+    asr_.close_session(session.asr_id);
+    add_gate_stats(*session.gate);
+
+    std::cout << "[Ingest] 会话结束 (" << reason << "): " << it->first << "，收到 " << session.frames
+              << " 帧 / " << static_cast<double>(session.samples) / asr_.sample_rate() << " 秒音频，丢帧 "
+              << session.lost_frames << std::endl;
+    finished_latency_.merge(*session.transport_latency);
+    ++sessions_ended_;
+    sessions_.erase(it);
+}
+
+void PcmIngestServer::close_idle_sessions() {
+    if (options_.session_idle_seconds <= 0) {
+        return;
+    }
+    auto deadline = std::chrono::steady_clock::now() -
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<float>(options_.session_idle_seconds));
+    for (auto it = sessions_.begin(); it != sessions_.end();) {
+        auto current = it++;
+        if (current->second.last_frame < deadline) {
+            end_session(current, "超时未收到音频");
+        }
+    }
+}
+
+void PcmIngestServer::add_gate_stats(const VadGate& gate) {
+    gate_samples_seen_ += gate.samples_seen();
+    gate_samples_skipped_ += gate.samples_skipped();
+    gate_saved_seconds_ += gate.saved_seconds();
+}
+
+void PcmIngestServer::print_stats() const {
+    std::cout << "\n===== PCM 接入统计 =====" << std::endl;
+    std::cout << "[Ingest] 收到 " << frames_received_ << " 帧，格式错误 " << malformed_frames_
+              << "，采样率/格式不支持 " << rejected_frames_ << "，已结束会话 " << sessions_ended_
+              << "，进行中 " << sessions_.size() << std::endl;
+    if (gate_samples_seen_ > 0) {
+        std::cout << "[Gate] 已结束会话: 跳过VAD推理 "
+                  << 100.0 * gate_samples_skipped_ / gate_samples_seen_ << "% 的音频，估算节省CPU "
+                  << gate_saved_seconds_ << " 秒" << std::endl;
+    }
+    if (finished_latency_.count() > 0) {
+        finished_latency_.print();
+    }
+    for (const auto& entry : sessions_) {
+        entry.second.transport_latency->print();
+    }
+    asr_.print_stats();
+}
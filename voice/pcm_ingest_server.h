@@ -0,0 +1,79 @@
+// pcm_ingest_server.h
+// 网络 PCM 接入服务端：通过 ZMQ PULL 接收远程采集端按会话发送的音频帧 (协议见 pcm_ingest.h)，
+// 每个会话有独立的 VAD，语音段送入共享识别器上该会话自己的流，识别统一批量解码。
+// 边缘设备只负责采集，模型集中部署在一台主机上。
+#ifndef PCM_INGEST_SERVER_H
+#define PCM_INGEST_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sherpa-onnx/c-api/cxx-api.h>
+#include "asr_batch_server.h"
+#include "latency_stats.h"
+#include "pcm_ingest.h"
+#include "vad_gate.h"
+#include "ZmqPuller.h"
+
+struct IngestOptions {
+    std::string address = "tcp://*:6680";    // 也可使用 ipc:// 地址
+    std::string vad_model_path;
+    float session_idle_seconds = 10.0f;      // 超过该时长未收到帧的会话视为断开并结束
+    VadGateOptions vad_gate;                 // 每个会话 VAD 前的能量门限
+};
+
+class PcmIngestServer {
+public:
+    using ResultCallback = std::function<void(const std::string& session, const std::string& text)>;
+
+    PcmIngestServer(const BatchServerOptions& asr_options, const IngestOptions& options,
+                    ResultCallback on_result);
+
+    // 接收并处理音频直到 running 变为 false，退出前结束所有会话并输出最后结果
+    void run(const std::atomic<bool>& running);
+    void print_stats() const;
+
+private:
+    struct Session {
+        AsrBatchServer::SessionId asr_id = 0;
+        std::unique_ptr<sherpa_onnx::cxx::VoiceActivityDetector> vad;
+        std::unique_ptr<VadGate> gate;
+        bool in_speech = false;
+        uint64_t next_sequence = 0;
+        uint64_t frames = 0;
+        uint64_t samples = 0;
+        uint64_t lost_frames = 0;
+        std::chrono::steady_clock::time_point last_frame;
+        std::unique_ptr<LatencyHistogram> transport_latency;
+    };
+
+    void handle_frame(std::vector<zmq::message_t>& parts);
+    Session& open_session(const std::string& key);
+    void feed(Session& session, const float* samples, size_t n);
+    void end_session(std::unordered_map<std::string, Session>::iterator it, const char* reason);
+    void close_idle_sessions();
+    void add_gate_stats(const VadGate& gate);
+
+    IngestOptions options_;
+    ResultCallback on_result_;
+    AsrBatchServer asr_;
+    zmq_component::ZmqPuller puller_;
+    std::unordered_map<std::string, Session> sessions_;
+    std::vector<float> scratch_;
+
+    // 统计
+    uint64_t frames_received_ = 0;
+    uint64_t malformed_frames_ = 0;
+    uint64_t rejected_frames_ = 0;
+    uint64_t sessions_ended_ = 0;
+    uint64_t gate_samples_seen_ = 0;
+    uint64_t gate_samples_skipped_ = 0;
+    double gate_saved_seconds_ = 0.0;
+    LatencyHistogram finished_latency_{"已结束会话 采集→到达"};   // 会话结束时合并进来
+};
+
+#endif // PCM_INGEST_SERVER_H
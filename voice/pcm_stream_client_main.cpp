@@ -0,0 +1,195 @@
+// pcm_stream_client_main.cpp
+// 远程采集端的替身：把 WAV 文件按实时节奏切成 PCM 帧，通过 ZMQ PUSH 发送给 asr_server --listen。
+// 16-bit WAV 的采样直接从 mmap 内存零拷贝发送；可用 --sessions 模拟多个采集端。
+
+#include "pcm_ingest.h"
+#include "sys_util.h"
+#include "wav_file_source.h"
+#include "ZmqPusher.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <signal.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::atomic<bool> g_running(true);
+
+void signal_handler(int signal) {
+    if (signal == SIGINT || signal == SIGTERM) {
+        g_running = false;
+    }
+}
+
+// 一个模拟的采集端：依次回放文件列表，文件之间插入静音
+struct ClientSession {
+    std::string id;
+    std::vector<const MappedWav*> files;
+    size_t file_index = 0;
+    size_t offset = 0;
+    size_t gap_remaining = 0;
+    bool in_gap = false;
+    uint64_t sequence = 0;
+    bool finished = false;
+};
+
+zmq::message_t make_header(const ClientSession& session, size_t sample_rate, uint32_t flags) {
+    PcmFrameHeader header;
+    header.sample_rate = static_cast<uint32_t>(sample_rate);
+    header.flags = flags;
+    header.sequence = session.sequence;
+    header.capture_time_us = now_us();
+    return zmq::message_t(&header, sizeof(header));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string address = "tcp://localhost:6680";
+    std::string session_prefix = "mic";
+    std::vector<std::string> wav_paths;
+    int num_sessions = 1;
+    int frame_ms = 100;
+    float gap_seconds = 1.0f;
+    bool fast = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--connect" && i + 1 < argc) {
+            address = argv[++i];
+        } else if (arg == "--session" && i + 1 < argc) {
+            session_prefix = argv[++i];
+        } else if (arg == "--sessions" && i + 1 < argc) {
+            num_sessions = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--wav" && i + 1 < argc) {
+            wav_paths.push_back(argv[++i]);
+        } else if (arg == "--frame-ms" && i + 1 < argc) {
+            frame_ms = std::max(10, std::stoi(argv[++i]));
+        } else if (arg == "--gap" && i + 1 < argc) {
+            gap_seconds = std::max(0.0f, std::stof(argv[++i]));
+        } else if (arg == "--fast") {
+            fast = true;
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "用法: " << argv[0] << " --wav PATH [选项]" << std::endl;
+            std::cout << "选项:" << std::endl;
+            std::cout << "  --connect ADDR             识别主机地址 (默认 tcp://localhost:6680)" << std::endl;
+            std::cout << "  --session NAME             会话ID前缀 (默认 mic)" << std::endl;
+            std::cout << "  --sessions N               模拟的采集端数量 (默认 1)" << std::endl;
+            std::cout << "  --wav PATH                 16-bit 单声道WAV文件或目录 (可重复)" << std::endl;
+            std::cout << "  --frame-ms MS              每帧时长 (默认 100)" << std::endl;
+            std::cout << "  --gap SEC                  文件之间插入的静音时长 (默认 1.0)" << std::endl;
+            std::cout << "  --fast                     尽可能快地发送 (默认按实时节奏)" << std::endl;
+            std::cout << "  --help, -h                 显示此帮助信息" << std::endl;
+            return 0;
+        }
+    }
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    // 映射的文件须比套接字活得久：零拷贝发送的消息在后台 I/O 线程发出前一直引用映射内存
+    std::vector<std::unique_ptr<MappedWav>> files;
+    int sample_rate = 0;
+    for (const auto& path : WavFileSource::expand_paths(wav_paths)) {
+        try {
+            auto wav = std::make_unique<MappedWav>(path);
+            if (wav->format() != MappedWav::Format::Pcm16) {
+                std::cerr << "跳过非16-bit文件: " << path << std::endl;
+                continue;
+            }
+            if (sample_rate != 0 && wav->sample_rate() != sample_rate) {
+                std::cerr << "跳过采样率不一致的文件: " << path << std::endl;
+                continue;
+            }
+            sample_rate = wav->sample_rate();
+            files.push_back(std::move(wav));
+        } catch (const std::exception& e) {
+            std::cerr << "错误：" << e.what() << std::endl;
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "错误：没有可发送的WAV文件 (使用 --wav 指定)" << std::endl;
+        return -1;
+    }
+
+    const size_t frame_samples = static_cast<size_t>(sample_rate) * frame_ms / 1000;
+    const std::vector<int16_t> silence(frame_samples, 0);
+
+    std::vector<ClientSession> sessions(num_sessions);
+    for (int i = 0; i < num_sessions; ++i) {
+        sessions[i].id = num_sessions == 1 ? session_prefix : session_prefix + "-" + std::to_string(i + 1);
+        for (size_t k = 0; k < files.size(); ++k) {
+            sessions[i].files.push_back(files[(i + k) % files.size()].get());
+        }
+    }
+
+    zmq_component::ZmqPusher pusher(address);
+    // 识别主机不在线时最多等待 1 秒把剩余帧发出，随后放弃
+    pusher.socket().set(zmq::sockopt::linger, 1000);
+    std::cout << "正在向 " << address << " 发送 " << num_sessions << " 路音频 ("
+              << (fast ? "尽可能快" : "实时节奏") << ")..." << std::endl;
+
+    const auto start = std::chrono::steady_clock::now();
+    size_t active = sessions.size();
+    uint64_t frames_sent = 0;
+    std::vector<zmq::message_t> parts(3);
+    for (uint64_t tick = 1; active > 0 && g_running; ++tick) {
+        for (auto& session : sessions) {
+            if (session.finished) {
+                continue;
+            }
+            // 当前文件及其后的静音都发送完后切换到下一个文件
+            const MappedWav* wav = session.files[session.file_index];
+            if (!session.in_gap && session.offset >= wav->num_samples()) {
+                session.in_gap = true;
+                session.gap_remaining = static_cast<size_t>(gap_seconds * sample_rate);
+            }
+            if (session.in_gap && session.gap_remaining == 0) {
+                session.in_gap = false;
+                session.offset = 0;
+                if (++session.file_index == session.files.size()) {
+                    parts[0] = zmq::message_t(session.id.data(), session.id.size());
+                    parts[1] = make_header(session, sample_rate, kPcmFlagEnd);
+                    parts[2] = zmq::message_t();
+                    pusher.pushMultipart(parts);
+                    session.finished = true;
+                    --active;
+                    continue;
+                }
+                wav = session.files[session.file_index];
+            }
+
+            const int16_t* samples;
+            size_t n;
+            if (session.in_gap) {
+                n = std::min(frame_samples, session.gap_remaining);
+                samples = silence.data();
+                session.gap_remaining -= n;
+            } else {
+                n = std::min(frame_samples, wav->num_samples() - session.offset);
+                samples = wav->pcm16() + session.offset;
+                session.offset += n;
+            }
+
+            parts[0] = zmq::message_t(session.id.data(), session.id.size());
+            parts[1] = make_header(session, sample_rate, 0);
+            // 不释放的零拷贝消息：直接引用映射内存 (或常驻的静音缓冲区)
+            parts[2] = zmq::message_t(const_cast<int16_t*>(samples), n * sizeof(int16_t), nullptr);
+            pusher.pushMultipart(parts);
+            ++session.sequence;
+            ++frames_sent;
+        }
+        if (!fast) {
+            std::this_thread::sleep_until(start + std::chrono::milliseconds(frame_ms * tick));
+        }
+    }
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "已发送 " << frames_sent << " 帧，用时 " << wall << " 秒" << std::endl;
+    return 0;
+}
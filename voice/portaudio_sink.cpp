@@ -0,0 +1,118 @@
+// portaudio_sink.cpp
+// PortAudio 阻塞式音频输出
+
+#include "portaudio_sink.h"
+#include "sys_util.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+PortAudioSink::PortAudioSink(int device_idx, int sample_rate)
+    : device_idx_(device_idx),
+      sample_rate_(sample_rate)
+{
+}
+
+PortAudioSink::~PortAudioSink() {
+    stop();
+}
+
+bool PortAudioSink::start() {
+    PaError err = Pa_Initialize();
+    if (err != paNoError) {
+        std::cerr << "!!! PortAudio 初始化失败: " << Pa_GetErrorText(err) << std::endl;
+        return false;
+    }
+    pa_initialized_ = true;
+
+    if (device_idx_ == -1) {
+        device_idx_ = Pa_GetDefaultOutputDevice();
+        if (device_idx_ == paNoDevice) {
+            std::cerr << "错误：没有默认输出设备。" << std::endl;
+            stop();
+            return false;
+        }
+    }
+    const PaDeviceInfo* device_info = Pa_GetDeviceInfo(device_idx_);
+    if (!device_info || device_info->maxOutputChannels < 1) {
+        std::cerr << "错误：设备 " << device_idx_ << " 不是输出设备。" << std::endl;
+        stop();
+        return false;
+    }
+
+    PaStreamParameters output_parameters;
+    output_parameters.device = device_idx_;
+    output_parameters.channelCount = 1;
+    output_parameters.sampleFormat = paFloat32;
+    output_parameters.suggestedLatency = device_info->defaultLowOutputLatency;
+    output_parameters.hostApiSpecificStreamInfo = nullptr;
+
+    err = Pa_OpenStream(&stream_, nullptr, &output_parameters, sample_rate_,
+                        paFramesPerBufferUnspecified, paClipOff, nullptr, nullptr);
+    if (err != paNoError) {
+        std::cerr << "打开音频输出流失败: " << Pa_GetErrorText(err) << std::endl;
+        stream_ = nullptr;
+        stop();
+        return false;
+    }
+    err = Pa_StartStream(stream_);
+    if (err != paNoError) {
+        std::cerr << "启动音频输出流失败: " << Pa_GetErrorText(err) << std::endl;
+        stop();
+        return false;
+    }
+
+    buffer_frames_ = std::max(0L, Pa_GetStreamWriteAvailable(stream_));
+    const PaStreamInfo* info = Pa_GetStreamInfo(stream_);
+    double latency = info ? info->outputLatency : device_info->defaultLowOutputLatency;
+    device_latency_ = std::max(0.0, latency - static_cast<double>(buffer_frames_) / sample_rate_);
+    device_name_ = device_info->name;
+    std::cout << "成功打开输出设备: " << device_name_ << " (索引 " << device_idx_ << ")，输出延迟 "
+              << latency * 1000.0 << " ms" << std::endl;
+    return true;
+}
+
+void PortAudioSink::stop() {
+    if (stream_) {
+        if (Pa_IsStreamActive(stream_) == 1) {
+            Pa_StopStream(stream_);
+        }
+        Pa_CloseStream(stream_);
+        stream_ = nullptr;
+    }
+    if (pa_initialized_) {
+        Pa_Terminate();
+        pa_initialized_ = false;
+    }
+}
+
+int64_t PortAudioSink::next_play_time_us() const {
+    int64_t now = now_us();
+    if (!stream_) {
+        return now;
+    }
+    long queued = std::max(0L, buffer_frames_ - std::max(0L, Pa_GetStreamWriteAvailable(stream_)));
+    double ahead = static_cast<double>(queued) / sample_rate_ + device_latency_;
+    return now + static_cast<int64_t>(ahead * 1e6);
+}
+
+bool PortAudioSink::write(const float* samples, size_t n) {
+    if (!stream_) {
+        return false;
+    }
+    PaError err = Pa_WriteStream(stream_, samples, n);
+    // 欠载只是出现了一段静音，数据仍已写入
+    return err == paNoError || err == paOutputUnderflowed;
+}
+
+void PortAudioSink::flush() {
+    if (!stream_) {
+        return;
+    }
+    // 中止会立即丢弃缓冲区中的数据，随后重新启动以便继续播放
+    Pa_AbortStream(stream_);
+    PaError err = Pa_StartStream(stream_);
+    if (err != paNoError) {
+        std::cerr << "重新启动音频输出流失败: " << Pa_GetErrorText(err) << std::endl;
+    }
+}
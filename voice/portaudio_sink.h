@@ -0,0 +1,44 @@
+// portaudio_sink.h
+// 基于 PortAudio 的阻塞式音频输出，供 TTS 服务播放合成的语音
+#ifndef PORTAUDIO_SINK_H
+#define PORTAUDIO_SINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <portaudio.h>
+
+class PortAudioSink {
+public:
+    // device_idx 为 -1 时使用默认输出设备
+    PortAudioSink(int device_idx, int sample_rate);
+    ~PortAudioSink();
+
+    PortAudioSink(const PortAudioSink&) = delete;
+    PortAudioSink& operator=(const PortAudioSink&) = delete;
+
+    bool start();
+    void stop();
+
+    // 下一次 write() 的第一个采样预计从扬声器播出的时刻 (system_clock 微秒)：
+    // 当前时刻 + 输出缓冲区中尚未播放的采样 + 设备自身的延迟。在 write() 之前调用
+    int64_t next_play_time_us() const;
+    // 阻塞直到全部写入输出缓冲区
+    bool write(const float* samples, size_t n);
+    // 丢弃已写入但尚未播放的音频 (用户打断时)，之后可继续 write()
+    void flush();
+
+    int sample_rate() const { return sample_rate_; }
+    const std::string& name() const { return device_name_; }
+
+private:
+    int device_idx_;
+    int sample_rate_;
+    std::string device_name_;
+    PaStream* stream_ = nullptr;
+    bool pa_initialized_ = false;
+    long buffer_frames_ = 0;            // 输出缓冲区容量 (启动时空缓冲区的可写采样数)
+    double device_latency_ = 0.0;       // 超出缓冲区部分的设备延迟 (秒)
+};
+
+#endif // PORTAUDIO_SINK_H
@@ -0,0 +1,214 @@
+// portaudio_source.cpp
+// PortAudio 实时输入源：支持阻塞读取与回调 + 无锁环形缓冲区两种采集模式
+
+#include "portaudio_source.h"
+#include <chrono>
+#include <iostream>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+
+PortAudioSource::PortAudioSource(int device_idx, int sample_rate, int frames_per_buffer,
+                                 CaptureMode mode, float ring_buffer_seconds)
+    : device_idx_(device_idx),
+      sample_rate_(sample_rate),
+      frames_per_buffer_(frames_per_buffer),
+      mode_(mode),
+      ring_buffer_seconds_(ring_buffer_seconds)
+{
+}
+
+PortAudioSource::~PortAudioSource() {
+    stop();
+}
+
+std::vector<AudioDevice> PortAudioSource::list_audio_devices() {
+    std::vector<AudioDevice> devices;
+    int num_devices = Pa_GetDeviceCount();
+    std::cout << "\n=== 可用的音频设备 ===" << std::endl;
+    for (int i = 0; i < num_devices; ++i) {
+        const PaDeviceInfo* device_info = Pa_GetDeviceInfo(i);
+        if (device_info && device_info->maxInputChannels > 0) {
+            AudioDevice device;
+            device.index = i;
+            device.name = device_info->name;
+            device.is_input = true;
+            devices.push_back(device);
+            std::cout << i << ": " << device.name << " (输入)" << std::endl;
+        }
+    }
+    int default_input = Pa_GetDefaultInputDevice();
+    if (default_input != paNoDevice) {
+        const PaDeviceInfo* default_info = Pa_GetDeviceInfo(default_input);
+        if (default_info) {
+            std::cout << "\n默认输入设备: " << default_info->name << " (索引 " << default_input << ")" << std::endl;
+        }
+    }
+    return devices;
+}
+
+bool PortAudioSource::start() {
+    PaError err = Pa_Initialize();
+    if (err != paNoError) {
+        std::cerr << "!!! PortAudio 初始化失败: " << Pa_GetErrorText(err) << std::endl;
+        return false;
+    }
+    pa_initialized_ = true;
+
+    auto devices = list_audio_devices();
+    if (devices.empty()) {
+        std::cerr << "错误：未找到任何音频输入设备。" << std::endl;
+        stop();
+        return false;
+    }
+
+    if (device_idx_ == -1) {
+        device_idx_ = Pa_GetDefaultInputDevice();
+        if (device_idx_ == paNoDevice) {
+            std::cerr << "错误：没有默认输入设备，将使用第一个可用设备。" << std::endl;
+            device_idx_ = devices[0].index;
+        }
+    }
+
+    PaStreamParameters input_parameters;
+    input_parameters.device = device_idx_;
+    input_parameters.channelCount = 1;
+    input_parameters.sampleFormat = paFloat32;
+    input_parameters.suggestedLatency = 0.1;
+    input_parameters.hostApiSpecificStreamInfo = nullptr;
+
+    const bool use_callback = (mode_ == CaptureMode::Callback);
+    if (use_callback) {
+        capture_ring_ = std::make_unique<SpscRingBuffer<float>>(
+            static_cast<size_t>(ring_buffer_seconds_ * sample_rate_));
+        pa_input_overflows_ = 0;
+        ready_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (ready_fd_ < 0) {
+            std::cerr << "创建采集通知 eventfd 失败" << std::endl;
+            stop();
+            return false;
+        }
+    }
+
+    err = Pa_OpenStream(&audio_stream_, &input_parameters, nullptr, sample_rate_,
+                        frames_per_buffer_, paNoFlag,
+                        use_callback ? &PortAudioSource::pa_input_callback : nullptr,
+                        use_callback ? this : nullptr);
+    if (err != paNoError) {
+        std::cerr << "打开音频流失败: " << Pa_GetErrorText(err) << std::endl;
+        audio_stream_ = nullptr;
+        stop();
+        return false;
+    }
+
+    err = Pa_StartStream(audio_stream_);
+    if (err != paNoError) {
+        std::cerr << "启动音频流失败: " << Pa_GetErrorText(err) << std::endl;
+        stop();
+        return false;
+    }
+
+    device_name_ = Pa_GetDeviceInfo(device_idx_)->name;
+    std::cout << "\n成功打开设备: " << device_name_ << " (索引 " << device_idx_ << ")" << std::endl;
+    if (use_callback) {
+        std::cout << "采集模式: 回调 + 无锁环形缓冲区 (容量 "
+                  << capture_ring_->capacity() * 1000 / sample_rate_ << " ms)" << std::endl;
+    }
+    return true;
+}
+
+void PortAudioSource::stop() {
+    if (audio_stream_) {
+        if (Pa_IsStreamActive(audio_stream_) == 1) {
+            Pa_StopStream(audio_stream_);
+        }
+        Pa_CloseStream(audio_stream_);
+        audio_stream_ = nullptr;
+    }
+    if (pa_initialized_) {
+        Pa_Terminate();
+        pa_initialized_ = false;
+    }
+    if (ready_fd_ >= 0) {
+        ::close(ready_fd_);
+        ready_fd_ = -1;
+    }
+}
+
+ReadStatus PortAudioSource::read(AudioFrame& frame, size_t max_samples, int timeout_ms) {
+    if (!audio_stream_) {
+        return ReadStatus::Error;
+    }
+    if (buffer_.size() < max_samples) {
+        buffer_.resize(max_samples);
+    }
+
+    if (mode_ == CaptureMode::Blocking) {
+        PaError err = Pa_ReadStream(audio_stream_, buffer_.data(), max_samples);
+        if (err != paNoError) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return ReadStatus::NotReady;
+        }
+        frame.data = buffer_.data();
+        frame.size = max_samples;
+        return ReadStatus::Ok;
+    }
+
+    // 回调模式：等待环形缓冲区中攒够一帧。先清空 eventfd 再检查缓冲区，
+    // 之后到达的数据一定会再次触发通知，不会漏掉唤醒
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true) {
+        uint64_t pending;
+        while (::read(ready_fd_, &pending, sizeof(pending)) == sizeof(pending)) {
+        }
+        if (capture_ring_->size() >= max_samples) {
+            break;
+        }
+        int wait_ms = -1;
+        if (timeout_ms >= 0) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) {
+                return ReadStatus::NotReady;
+            }
+            wait_ms = static_cast<int>(remaining);
+        }
+        pollfd pfd{ready_fd_, POLLIN, 0};
+        ::poll(&pfd, 1, wait_ms);
+    }
+    frame.data = buffer_.data();
+    frame.size = capture_ring_->pop(buffer_.data(), max_samples);
+    return ReadStatus::Ok;
+}
+
+// PortAudio 回调：运行在实时音频线程中，只做无锁拷贝和一次非阻塞的 eventfd 写入，
+// 不加锁、不分配内存、不打印
+int PortAudioSource::pa_input_callback(const void* input, void* /*output*/, unsigned long frame_count,
+                                       const PaStreamCallbackTimeInfo* /*time_info*/,
+                                       PaStreamCallbackFlags status_flags, void* user_data) {
+    auto* self = static_cast<PortAudioSource*>(user_data);
+    if (status_flags & paInputOverflow) {
+        self->pa_input_overflows_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (input) {
+        self->capture_ring_->push(static_cast<const float*>(input), frame_count);
+        uint64_t one = 1;
+        ssize_t written = ::write(self->ready_fd_, &one, sizeof(one));
+        (void)written;
+    }
+    return paContinue;
+}
+
+void PortAudioSource::print_stats() const {
+    if (!capture_ring_) {
+        return;
+    }
+    auto to_ms = [this](size_t samples) { return samples * 1000 / sample_rate_; };
+    std::cout << "[Capture] 环形缓冲: 当前 " << to_ms(capture_ring_->size()) << " ms"
+              << " / 峰值 " << to_ms(capture_ring_->high_watermark()) << " ms"
+              << " / 容量 " << to_ms(capture_ring_->capacity()) << " ms"
+              << ", 缓冲区溢出 " << capture_ring_->overflow_count() << " 次"
+              << " (丢弃 " << capture_ring_->dropped_count() << " 个采样)"
+              << ", PortAudio 输入溢出 " << pa_input_overflows_.load() << " 次" << std::endl;
+}
@@ -0,0 +1,69 @@
+// portaudio_source.h
+// 基于 PortAudio 的实时麦克风输入源
+#ifndef PORTAUDIO_SOURCE_H
+#define PORTAUDIO_SOURCE_H
+
+#include "audio_source.h"
+#include "spsc_ring_buffer.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <portaudio.h>
+
+struct AudioDevice {
+    int index;
+    std::string name;
+    bool is_input;
+};
+
+// 采集模式
+// Blocking: 在处理线程中用 Pa_ReadStream 阻塞读取 (原有方式)
+// Callback: PortAudio 回调线程写入无锁环形缓冲区并通过 eventfd 通知，处理线程从中取数据
+enum class CaptureMode {
+    Blocking,
+    Callback
+};
+
+class PortAudioSource : public AudioSource {
+public:
+    PortAudioSource(int device_idx, int sample_rate, int frames_per_buffer,
+                    CaptureMode mode = CaptureMode::Blocking, float ring_buffer_seconds = 2.0f);
+    ~PortAudioSource() override;
+
+    bool start() override;
+    void stop() override;
+    ReadStatus read(AudioFrame& frame, size_t max_samples, int timeout_ms) override;
+
+    int sample_rate() const override { return sample_rate_; }
+    std::string name() const override { return device_name_; }
+    // 仅回调模式支持：每次回调写入数据后 eventfd 变为可读
+    int ready_fd() const override { return mode_ == CaptureMode::Callback ? ready_fd_ : -1; }
+    void print_stats() const override;
+
+    // 需在 Pa_Initialize 之后调用
+    static std::vector<AudioDevice> list_audio_devices();
+
+private:
+    static int pa_input_callback(const void* input, void* output, unsigned long frame_count,
+                                 const PaStreamCallbackTimeInfo* time_info,
+                                 PaStreamCallbackFlags status_flags, void* user_data);
+
+    int device_idx_;
+    int sample_rate_;
+    int frames_per_buffer_;
+    CaptureMode mode_;
+    float ring_buffer_seconds_;
+    std::string device_name_;
+
+    PaStream* audio_stream_ = nullptr;
+    bool pa_initialized_ = false;
+    std::vector<float> buffer_;
+
+    // 回调采集模式使用的环形缓冲区及 PortAudio 层面的溢出计数
+    std::unique_ptr<SpscRingBuffer<float>> capture_ring_;
+    std::atomic<uint64_t> pa_input_overflows_{0};
+    int ready_fd_ = -1;
+};
+
+#endif // PORTAUDIO_SOURCE_H
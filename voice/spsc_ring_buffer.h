@@ -0,0 +1,93 @@
+// spsc_ring_buffer.h
+// 单生产者/单消费者 (SPSC) 无锁环形缓冲区
+// 生产者为 PortAudio 回调线程，消费者为 VAD/ASR 处理线程。
+// 缓冲区在构造时一次性分配，push/pop 过程中不加锁、不分配内存。
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+template <typename T>
+class SpscRingBuffer {
+public:
+    // 容量向上取整为 2 的幂，便于用掩码代替取模
+    explicit SpscRingBuffer(size_t min_capacity) {
+        size_t capacity = 1;
+        while (capacity < min_capacity) {
+            capacity <<= 1;
+        }
+        buffer_.resize(capacity);
+        mask_ = capacity - 1;
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    // 仅限生产者线程调用。空间不足时只写入能放下的部分，其余计入溢出统计。
+    size_t push(const T* data, size_t n) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t free_space = capacity() - (head - tail);
+        const size_t to_write = std::min(n, free_space);
+
+        const size_t start = head & mask_;
+        const size_t first = std::min(to_write, capacity() - start);
+        std::copy(data, data + first, buffer_.begin() + start);
+        std::copy(data + first, data + to_write, buffer_.begin());
+        head_.store(head + to_write, std::memory_order_release);
+
+        if (to_write < n) {
+            overflow_count_.fetch_add(1, std::memory_order_relaxed);
+            dropped_.fetch_add(n - to_write, std::memory_order_relaxed);
+        }
+        const size_t fill = head + to_write - tail;
+        if (fill > high_watermark_.load(std::memory_order_relaxed)) {
+            high_watermark_.store(fill, std::memory_order_relaxed);
+        }
+        return to_write;
+    }
+
+    // 仅限消费者线程调用。返回实际读出的元素个数。
+    size_t pop(T* out, size_t n) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t to_read = std::min(n, head - tail);
+
+        const size_t start = tail & mask_;
+        const size_t first = std::min(to_read, capacity() - start);
+        std::copy(buffer_.begin() + start, buffer_.begin() + start + first, out);
+        std::copy(buffer_.begin(), buffer_.begin() + (to_read - first), out + first);
+        tail_.store(tail + to_read, std::memory_order_release);
+        return to_read;
+    }
+
+    // 当前缓冲的元素个数 (任意线程可调用，结果为近似快照)
+    size_t size() const {
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t head = head_.load(std::memory_order_acquire);
+        return head - tail;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+    size_t high_watermark() const { return high_watermark_.load(std::memory_order_relaxed); }
+    uint64_t overflow_count() const { return overflow_count_.load(std::memory_order_relaxed); }
+    uint64_t dropped_count() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<T> buffer_;
+    size_t mask_ = 0;
+
+    // 读写索引单调递增，分别放在独立缓存行上以避免伪共享
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+
+    alignas(64) std::atomic<size_t> high_watermark_{0};
+    std::atomic<uint64_t> overflow_count_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+#endif // SPSC_RING_BUFFER_H
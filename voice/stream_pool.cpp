@@ -0,0 +1,107 @@
+// stream_pool.cpp
+// OnlineStream 池：后台创建与释放
+
+#include "stream_pool.h"
+#include <chrono>
+
+using namespace sherpa_onnx::cxx;
+
+StreamPool::StreamPool(const OnlineRecognizer& recognizer, size_t capacity)
+    : recognizer_(recognizer),
+      capacity_(capacity)
+{
+    if (capacity_ > 0) {
+        worker_ = std::thread(&StreamPool::refill_loop, this);
+    }
+}
+
+StreamPool::~StreamPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+std::unique_ptr<OnlineStream> StreamPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++acquired_;
+        if (!ready_.empty()) {
+            auto stream = std::move(ready_.front());
+            ready_.pop_front();
+            cv_.notify_one();
+            return stream;
+        }
+    }
+    // 池已耗尽 (或未启用)：只能在调用线程中创建
+    auto t0 = std::chrono::steady_clock::now();
+    auto stream = std::make_unique<OnlineStream>(recognizer_.CreateStream());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++sync_creates_;
+    sync_create_seconds_ += seconds;
+    cv_.notify_one();
+    return stream;
+}
+
+void StreamPool::release(std::unique_ptr<OnlineStream> stream) {
+    if (!stream) {
+        return;
+    }
+    if (capacity_ == 0) {
+        return;  // 未启用时就地释放
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    retired_.push_back(std::move(stream));
+    cv_.notify_one();
+}
+
+void StreamPool::refill_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !retired_.empty() || ready_.size() < capacity_; });
+        if (stopping_) {
+            break;
+        }
+        // 创建与释放都在锁外进行，acquire() 不会被阻塞
+        std::vector<std::unique_ptr<OnlineStream>> retired;
+        retired.swap(retired_);
+        bool need_stream = ready_.size() < capacity_;
+        lock.unlock();
+
+        size_t destroyed = retired.size();
+        retired.clear();
+        std::unique_ptr<OnlineStream> stream;
+        double seconds = 0.0;
+        if (need_stream) {
+            auto t0 = std::chrono::steady_clock::now();
+            stream = std::make_unique<OnlineStream>(recognizer_.CreateStream());
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        }
+
+        lock.lock();
+        background_destroys_ += destroyed;
+        if (stream) {
+            ready_.push_back(std::move(stream));
+            ++background_creates_;
+            background_create_seconds_ += seconds;
+        }
+    }
+    // 退出时池中剩余的流随 ready_/retired_ 一起在析构中释放
+}
+
+void StreamPool::print_stats(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (capacity_ == 0) {
+        os << "[Pool] 未启用流池: 创建识别流 " << sync_creates_ << " 次，全部在处理线程中，共耗时 "
+           << sync_create_seconds_ * 1000.0 << " ms" << std::endl;
+        return;
+    }
+    os << "[Pool] 取用识别流 " << acquired_ << " 次，其中池为空需在处理线程中创建 " << sync_creates_
+       << " 次 (" << sync_create_seconds_ * 1000.0 << " ms)；后台创建 " << background_creates_ << " 次 ("
+       << background_create_seconds_ * 1000.0 << " ms)、释放 " << background_destroys_ << " 次" << std::endl;
+}
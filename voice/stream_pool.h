@@ -0,0 +1,54 @@
+// stream_pool.h
+// OnlineStream 池：后台线程预先创建好识别流，一句话结束时换上新流只需交换指针；
+// 用完的流也交给后台线程释放。CreateStream 会分配编码器状态，放在处理线程里会推迟下一句的开始。
+#ifndef STREAM_POOL_H
+#define STREAM_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sherpa-onnx/c-api/cxx-api.h>
+
+class StreamPool {
+public:
+    // capacity 为 0 时不启动后台线程，acquire() 直接同步创建 (即未使用池时的行为)
+    StreamPool(const sherpa_onnx::cxx::OnlineRecognizer& recognizer, size_t capacity);
+    ~StreamPool();
+    StreamPool(const StreamPool&) = delete;
+    StreamPool& operator=(const StreamPool&) = delete;
+
+    // 取出一个新流；池为空时在调用线程中同步创建 (计为未命中)
+    std::unique_ptr<sherpa_onnx::cxx::OnlineStream> acquire();
+    // 归还用完的流，由后台线程释放
+    void release(std::unique_ptr<sherpa_onnx::cxx::OnlineStream> stream);
+
+    void print_stats(std::ostream& os = std::cout) const;
+
+private:
+    void refill_loop();
+
+    const sherpa_onnx::cxx::OnlineRecognizer& recognizer_;
+    const size_t capacity_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::unique_ptr<sherpa_onnx::cxx::OnlineStream>> ready_;
+    std::vector<std::unique_ptr<sherpa_onnx::cxx::OnlineStream>> retired_;
+    bool stopping_ = false;
+    std::thread worker_;
+
+    // 统计 (受 mutex_ 保护)
+    uint64_t acquired_ = 0;
+    uint64_t sync_creates_ = 0;       // 在调用线程中创建的次数，即落在关键路径上的分配
+    uint64_t background_creates_ = 0;
+    uint64_t background_destroys_ = 0;
+    double sync_create_seconds_ = 0.0;
+    double background_create_seconds_ = 0.0;
+};
+
+#endif // STREAM_POOL_H
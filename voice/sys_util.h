@@ -0,0 +1,45 @@
+// sys_util.h
+// 各程序共用的小工具：墙上时钟、本程序的缓存目录、逐级创建目录
+#ifndef SYS_UTIL_H
+#define SYS_UTIL_H
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <sys/stat.h>
+
+// 当前墙上时钟 (system_clock 微秒)，跨进程/跨主机的时间戳统一使用它
+inline int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// $XDG_CACHE_HOME/voice_assistant，未设置时为 ~/.cache/voice_assistant
+inline std::string cache_dir() {
+    const char* cache = std::getenv("XDG_CACHE_HOME");
+    std::string dir;
+    if (cache && *cache) {
+        dir = cache;
+    } else {
+        const char* home = std::getenv("HOME");
+        dir = std::string(home ? home : ".") + "/.cache";
+    }
+    return dir + "/voice_assistant";
+}
+
+// 逐级创建目录 (mkdir -p)
+inline bool make_dirs(const std::string& dir) {
+    for (size_t pos = 1; pos <= dir.size(); ++pos) {
+        if (pos == dir.size() || dir[pos] == '/') {
+            std::string prefix = dir.substr(0, pos);
+            if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#endif // SYS_UTIL_H
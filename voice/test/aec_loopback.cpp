@@ -0,0 +1,232 @@
+// aec_loopback.cpp
+// 回声消除的合成回环测试：远端语音 (模拟 TTS) 经合成的房间冲激响应成为回声，
+// 与延后开始的近端语音 (模拟用户插话) 及底噪混合成麦克风信号；
+// 远端信号按 TTS::PCM 消息格式、以 TTS 采样率经 EchoReference 对齐后作为参考，
+// 报告只有回声时段的回声衰减 (ERLE) 和双讲时段近端语音的失真。ERLE 低于 --min-erle 时返回 1。
+
+#include "echo_canceller.h"
+#include "echo_reference.h"
+#include "wav_file_source.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<float> load_wav(const std::string& path, int& sample_rate) {
+    MappedWav wav(path);
+    sample_rate = wav.sample_rate();
+    std::vector<float> samples(wav.num_samples());
+    wav.to_float(0, samples.size(), samples.data());
+    return samples;
+}
+
+void write_wav(const std::string& path, const std::vector<float>& samples, int sample_rate) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        std::cerr << "无法写入 " << path << std::endl;
+        return;
+    }
+    uint32_t data_bytes = static_cast<uint32_t>(samples.size() * 2);
+    uint32_t riff_size = 36 + data_bytes;
+    uint32_t fmt_size = 16;
+    uint16_t format = 1, channels = 1, block_align = 2, bits = 16;
+    uint32_t rate = static_cast<uint32_t>(sample_rate), byte_rate = rate * 2;
+    std::fwrite("RIFF", 1, 4, f);
+    std::fwrite(&riff_size, 4, 1, f);
+    std::fwrite("WAVEfmt ", 1, 8, f);
+    std::fwrite(&fmt_size, 4, 1, f);
+    std::fwrite(&format, 2, 1, f);
+    std::fwrite(&channels, 2, 1, f);
+    std::fwrite(&rate, 4, 1, f);
+    std::fwrite(&byte_rate, 4, 1, f);
+    std::fwrite(&block_align, 2, 1, f);
+    std::fwrite(&bits, 2, 1, f);
+    std::fwrite("data", 1, 4, f);
+    std::fwrite(&data_bytes, 4, 1, f);
+    for (float s : samples) {
+        int16_t v = static_cast<int16_t>(std::max(-1.0f, std::min(1.0f, s)) * 32767.0f);
+        std::fwrite(&v, 2, 1, f);
+    }
+    std::fclose(f);
+}
+
+// 直达声 + 指数衰减的随机反射，种子固定以便结果可复现
+std::vector<float> make_room_response(int sample_rate, float delay_ms, float gain, float tail_ms) {
+    size_t delay = static_cast<size_t>(delay_ms * sample_rate / 1000.0f);
+    size_t tail = static_cast<size_t>(tail_ms * sample_rate / 1000.0f);
+    std::vector<float> h(delay + tail, 0.0f);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    h[delay] = gain;
+    for (size_t i = 1; i < tail; ++i) {
+        float decay = std::exp(-static_cast<float>(i) / (0.02f * sample_rate));
+        h[delay + i] = 0.1f * gain * decay * uniform(rng);
+    }
+    return h;
+}
+
+double energy(const std::vector<float>& x, size_t from, size_t to) {
+    double e = 0.0;
+    for (size_t i = from; i < to && i < x.size(); ++i) {
+        e += static_cast<double>(x[i]) * x[i];
+    }
+    return e;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::string wav_dir = "./models/sherpa-onnx-streaming-zipformer-small-bilingual-zh-en-2023-02-16/test_wavs/";
+    std::string near_path = wav_dir + "0.wav";
+    std::string far_path = wav_dir + "1.wav";
+    std::string out_path;
+    float echo_delay_ms = 30.0f;
+    float echo_gain = 0.3f;
+    int tts_rate = 22050;
+    float min_erle = 12.0f;
+    EchoCancellerOptions options;
+    options.enabled = true;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--near" && i + 1 < argc) {
+            near_path = argv[++i];
+        } else if (arg == "--far" && i + 1 < argc) {
+            far_path = argv[++i];
+        } else if (arg == "--echo-delay" && i + 1 < argc) {
+            echo_delay_ms = std::stof(argv[++i]);
+        } else if (arg == "--echo-gain" && i + 1 < argc) {
+            echo_gain = std::stof(argv[++i]);
+        } else if (arg == "--tts-rate" && i + 1 < argc) {
+            tts_rate = std::stoi(argv[++i]);
+        } else if (arg == "--filter-ms" && i + 1 < argc) {
+            options.filter_ms = std::stof(argv[++i]);
+        } else if (arg == "--step" && i + 1 < argc) {
+            options.step_size = std::stof(argv[++i]);
+        } else if (arg == "--min-erle" && i + 1 < argc) {
+            min_erle = std::stof(argv[++i]);
+        } else if (arg == "--out" && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "用法: " << argv[0] << " [选项]" << std::endl;
+            std::cout << "选项:" << std::endl;
+            std::cout << "  --near PATH                近端 (用户) 语音 (默认 test_wavs/0.wav)" << std::endl;
+            std::cout << "  --far PATH                 远端 (TTS) 语音 (默认 test_wavs/1.wav)" << std::endl;
+            std::cout << "  --echo-delay MS            合成回声的直达声延迟 (默认 30)" << std::endl;
+            std::cout << "  --echo-gain G              合成回声的直达声增益 (默认 0.3)" << std::endl;
+            std::cout << "  --tts-rate HZ              参考信号按此采样率发布，检验重采样 (默认 22050)" << std::endl;
+            std::cout << "  --filter-ms MS             回声消除滤波器长度 (默认 128)" << std::endl;
+            std::cout << "  --step MU                  NLMS 步长 (默认 0.2)" << std::endl;
+            std::cout << "  --min-erle DB              ERLE 低于此值时返回 1 (默认 12)" << std::endl;
+            std::cout << "  --out PATH                 写出消除回声后的信号" << std::endl;
+            std::cout << "  --help, -h                 显示此帮助信息" << std::endl;
+            return 0;
+        }
+    }
+
+    int sample_rate = 0;
+    int far_rate = 0;
+    std::vector<float> near, far;
+    try {
+        near = load_wav(near_path, sample_rate);
+        far = load_wav(far_path, far_rate);
+    } catch (const std::exception& e) {
+        std::cerr << "读取WAV失败: " << e.what() << std::endl;
+        return 1;
+    }
+    if (far_rate != sample_rate) {
+        std::cerr << "近端与远端的采样率不同: " << sample_rate << " / " << far_rate << std::endl;
+        return 1;
+    }
+
+    // 远端从 0 秒开始播放，近端在远端过半时开始说话：前半段只有回声，之后是双讲
+    const size_t near_start = far.size() / 2;
+    const size_t total = std::max(far.size(), near_start + near.size());
+    std::vector<float> h = make_room_response(sample_rate, echo_delay_ms, echo_gain, 80.0f);
+    std::vector<float> echo(total, 0.0f);
+    for (size_t i = 0; i < total; ++i) {
+        double acc = 0.0;
+        for (size_t k = 0; k < h.size() && k <= i; ++k) {
+            if (i - k < far.size()) {
+                acc += h[k] * far[i - k];
+            }
+        }
+        echo[i] = static_cast<float>(acc);
+    }
+    std::vector<float> mic(total);
+    std::vector<float> near_aligned(total, 0.0f);
+    std::mt19937 rng(11);
+    std::normal_distribution<float> noise(0.0f, 1e-3f);
+    for (size_t i = 0; i < total; ++i) {
+        if (i >= near_start && i - near_start < near.size()) {
+            near_aligned[i] = near[i - near_start];
+        }
+        mic[i] = echo[i] + near_aligned[i] + noise(rng);
+    }
+
+    // 参考信号：按 TTS 采样率每 20ms 发布一段，与线上消息格式相同
+    const int64_t base_us = 1700000000LL * 1000000;
+    EchoReference reference(sample_rate, static_cast<float>(total) / sample_rate + 1.0f);
+    {
+        size_t tts_n = static_cast<size_t>(static_cast<double>(far.size()) * tts_rate / sample_rate);
+        std::vector<int16_t> tts(tts_n);
+        for (size_t i = 0; i < tts_n; ++i) {
+            double pos = static_cast<double>(i) * sample_rate / tts_rate;
+            size_t j = static_cast<size_t>(pos);
+            float next = j + 1 < far.size() ? far[j + 1] : far[j];
+            float v = far[j] + (next - far[j]) * static_cast<float>(pos - j);
+            tts[i] = static_cast<int16_t>(std::max(-1.0f, std::min(1.0f, v)) * 32767.0f);
+        }
+        const size_t chunk = static_cast<size_t>(tts_rate / 50);
+        for (size_t offset = 0; offset < tts_n; offset += chunk) {
+            size_t n = std::min(chunk, tts_n - offset);
+            int64_t play_us = base_us + static_cast<int64_t>(offset) * 1000000 / tts_rate;
+            reference.push_message(encode_pcm_message(tts.data() + offset, n, tts_rate, play_us));
+        }
+    }
+
+    // 麦克风按 10ms 一帧处理，每帧按采集时刻取参考信号
+    EchoCanceller canceller(options, sample_rate);
+    std::vector<float> out(total);
+    std::vector<float> ref(sample_rate / 100);
+    for (size_t offset = 0; offset < total; offset += ref.size()) {
+        size_t n = std::min(ref.size(), total - offset);
+        int64_t capture_us = base_us + static_cast<int64_t>(offset) * 1000000 / sample_rate -
+                             static_cast<int64_t>(options.delay_ms * 1000.0f);
+        reference.read(capture_us, ref.data(), n);
+        canceller.process(mic.data() + offset, ref.data(), out.data() + offset, n);
+    }
+
+    // 前 1 秒留给滤波器收敛
+    const size_t converge = std::min<size_t>(sample_rate, near_start);
+    double erle = 10.0 * std::log10(energy(mic, converge, near_start) / energy(out, converge, near_start));
+    std::vector<float> residual(total);
+    for (size_t i = 0; i < total; ++i) {
+        residual[i] = out[i] - near_aligned[i];
+    }
+    size_t overlap_end = std::min(far.size() + h.size(), total);
+    double echo_to_near = 10.0 * std::log10(energy(near_aligned, near_start, overlap_end) /
+                                            energy(echo, near_start, overlap_end));
+    double near_snr = 10.0 * std::log10(energy(near_aligned, near_start, overlap_end) /
+                                        energy(residual, near_start, overlap_end));
+
+    std::cout << "只有回声时段 ERLE: " << erle << " dB" << std::endl;
+    std::cout << "双讲时段 近端/回声: 处理前 " << echo_to_near << " dB，处理后 " << near_snr << " dB" << std::endl;
+    canceller.print_stats();
+    reference.print_stats();
+    if (!out_path.empty()) {
+        write_wav(out_path, out, sample_rate);
+        std::cout << "已写出 " << out_path << std::endl;
+    }
+    if (erle < min_erle) {
+        std::cerr << "ERLE 低于 " << min_erle << " dB" << std::endl;
+        return 1;
+    }
+    return 0;
+}
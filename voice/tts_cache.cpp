@@ -0,0 +1,373 @@
+// tts_cache.cpp
+// 合成音频缓存：内存 LRU + mmap 磁盘文件
+
+#include "tts_cache.h"
+#include "sys_util.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// 磁盘文件：[文件头][键][填充到 4 字节对齐][float32 单声道采样]
+struct CacheFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t sample_rate;
+    uint32_t key_size;
+    uint64_t num_samples;
+};
+static_assert(sizeof(CacheFileHeader) == 24, "CacheFileHeader must be packed");
+
+constexpr char kCacheMagic[4] = {'V', 'T', 'T', 'S'};
+constexpr uint32_t kCacheVersion = 1;
+constexpr const char* kCacheSuffix = ".pcm";
+
+size_t data_offset(size_t key_size) {
+    return (sizeof(CacheFileHeader) + key_size + 3) & ~static_cast<size_t>(3);
+}
+
+uint64_t fnv1a64(const std::string& s) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : s) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 文件头中保存的键是否为 key
+bool file_has_key(const std::string& path, const std::string& key) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    CacheFileHeader header;
+    std::string stored(key.size(), '\0');
+    bool same = pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                header.key_size == key.size() &&
+                pread(fd, &stored[0], key.size(), sizeof(header)) == static_cast<ssize_t>(key.size()) &&
+                stored == key;
+    ::close(fd);
+    return same;
+}
+
+bool is_cache_file(const std::string& name) {
+    const size_t n = std::strlen(kCacheSuffix);
+    return name.size() > n && name.compare(name.size() - n, n, kCacheSuffix) == 0;
+}
+
+class HeapAudio : public TtsCache::Audio {
+public:
+    HeapAudio(const float* samples, size_t n, int sample_rate) : samples_(samples, samples + n) {
+        data_ = samples_.data();
+        size_ = samples_.size();
+        sample_rate_ = sample_rate;
+    }
+
+private:
+    std::vector<float> samples_;
+};
+
+class MappedAudio : public TtsCache::Audio {
+public:
+    MappedAudio(void* mapping, size_t mapping_size, size_t offset, size_t n, int sample_rate)
+        : mapping_(mapping), mapping_size_(mapping_size) {
+        data_ = reinterpret_cast<const float*>(static_cast<const uint8_t*>(mapping) + offset);
+        size_ = n;
+        sample_rate_ = sample_rate;
+    }
+    ~MappedAudio() override {
+        munmap(mapping_, mapping_size_);
+    }
+
+private:
+    void* mapping_;
+    size_t mapping_size_;
+};
+
+} // namespace
+
+std::string default_tts_cache_dir() {
+    return cache_dir() + "/tts";
+}
+
+std::string normalize_tts_text(const std::string& text) {
+    std::string result;
+    result.reserve(text.size());
+    bool pending_space = false;
+    for (char c : text) {
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            pending_space = !result.empty();
+            continue;
+        }
+        if (pending_space) {
+            result.push_back(' ');
+            pending_space = false;
+        }
+        result.push_back(c);
+    }
+    return result;
+}
+
+TtsCache::TtsCache(const TtsCacheOptions& options, std::string voice)
+    : options_(options),
+      voice_(std::move(voice))
+{
+    if (options_.directory != "none") {
+        directory_ = options_.directory.empty() ? default_tts_cache_dir() : options_.directory;
+        if (!make_dirs(directory_)) {
+            std::cerr << "[TTS缓存] 无法创建目录 " << directory_ << "，只使用内存缓存" << std::endl;
+            directory_.clear();
+        }
+    }
+    if (!directory_.empty()) {
+        scan_disk();
+    }
+}
+
+std::string TtsCache::make_key(const std::string& text) const {
+    return voice_ + '\n' + normalize_tts_text(text);
+}
+
+std::string TtsCache::file_path(const std::string& key) const {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(fnv1a64(key)));
+    return directory_ + "/" + name + kCacheSuffix;
+}
+
+std::shared_ptr<const TtsCache::Audio> TtsCache::lookup(const std::string& text) {
+    const std::string key = make_key(text);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        ++memory_hits_;
+        auto audio = it->second->audio;
+        saved_audio_seconds_ += static_cast<double>(audio->size()) / audio->sample_rate();
+        return audio;
+    }
+    if (!directory_.empty()) {
+        if (auto audio = load_file(key)) {
+            insert_memory(key, audio);
+            ++disk_hits_;
+            saved_audio_seconds_ += static_cast<double>(audio->size()) / audio->sample_rate();
+            return audio;
+        }
+    }
+    ++misses_;
+    return nullptr;
+}
+
+void TtsCache::store(const std::string& text, const float* samples, size_t n, int sample_rate) {
+    if (n == 0 || sample_rate <= 0 || static_cast<double>(n) / sample_rate > options_.max_entry_seconds) {
+        return;
+    }
+    const std::string key = make_key(text);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index_.count(key)) {
+        return;
+    }
+    insert_memory(key, std::make_shared<HeapAudio>(samples, n, sample_rate));
+    if (!directory_.empty()) {
+        write_file(key, samples, n, sample_rate);
+    }
+    ++stores_;
+}
+
+void TtsCache::insert_memory(const std::string& key, std::shared_ptr<const Audio> audio) {
+    memory_used_ += audio->size() * sizeof(float);
+    lru_.push_front({key, std::move(audio)});
+    index_[key] = lru_.begin();
+    // 至少保留刚插入的一条
+    while (memory_used_ > options_.memory_bytes && lru_.size() > 1) {
+        memory_used_ -= lru_.back().audio->size() * sizeof(float);
+        index_.erase(lru_.back().key);
+        lru_.pop_back();
+    }
+}
+
+std::shared_ptr<const TtsCache::Audio> TtsCache::load_file(const std::string& key) {
+    const std::string path = file_path(key);
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(CacheFileHeader)) {
+        ::close(fd);
+        return nullptr;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    const uint8_t* base = static_cast<const uint8_t*>(mapping);
+    CacheFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    const size_t offset = data_offset(header.key_size);
+    const bool valid = std::memcmp(header.magic, kCacheMagic, 4) == 0 && header.version == kCacheVersion &&
+                       header.sample_rate > 0 && offset <= size &&
+                       header.num_samples == (size - offset) / sizeof(float) &&
+                       (size - offset) % sizeof(float) == 0;
+    if (!valid) {
+        // 写入中断或版本不符：删除，下次合成后重新写入
+        munmap(mapping, size);
+        if (unlink(path.c_str()) == 0) {
+            disk_used_ -= std::min(disk_used_, size);
+        }
+        return nullptr;
+    }
+    if (header.key_size != key.size() || std::memcmp(base + sizeof(header), key.data(), key.size()) != 0) {
+        // 哈希冲突：保留原文件，按未命中处理
+        munmap(mapping, size);
+        return nullptr;
+    }
+    // 更新修改时间，磁盘淘汰按最久未使用
+    utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+    return std::make_shared<MappedAudio>(mapping, size, offset, header.num_samples,
+                                         static_cast<int>(header.sample_rate));
+}
+
+void TtsCache::write_file(const std::string& key, const float* samples, size_t n, int sample_rate) {
+    const std::string path = file_path(key);
+    if (access(path.c_str(), F_OK) == 0) {
+        // lookup() 已删除损坏的文件，此时仍存在的同名文件属于哈希相同的另一个键 (或另一个进程刚写入的同一个键)：
+        // 保留原文件，这一条只缓存在内存中
+        if (!file_has_key(path, key)) {
+            ++disk_collisions_;
+        }
+        return;
+    }
+
+    CacheFileHeader header;
+    std::memcpy(header.magic, kCacheMagic, 4);
+    header.version = kCacheVersion;
+    header.sample_rate = static_cast<uint32_t>(sample_rate);
+    header.key_size = static_cast<uint32_t>(key.size());
+    header.num_samples = n;
+    std::vector<uint8_t> buffer(data_offset(key.size()) + n * sizeof(float), 0);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    std::memcpy(buffer.data() + sizeof(header), key.data(), key.size());
+    std::memcpy(buffer.data() + data_offset(key.size()), samples, n * sizeof(float));
+
+    // 先写临时文件再改名，其他进程或崩溃后都不会读到写了一半的文件
+    const std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return;
+    }
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t r = ::write(fd, buffer.data() + written, buffer.size() - written);
+        if (r <= 0) {
+            if (r < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        written += static_cast<size_t>(r);
+    }
+    ::close(fd);
+    if (written != buffer.size() || rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "[TTS缓存] 写入失败: " << path << std::endl;
+        unlink(tmp_path.c_str());
+        return;
+    }
+    disk_used_ += buffer.size();
+    if (disk_used_ > options_.disk_bytes) {
+        trim_disk();
+    }
+}
+
+void TtsCache::scan_disk() {
+    disk_used_ = 0;
+    size_t files = 0;
+    if (DIR* d = opendir(directory_.c_str())) {
+        while (dirent* entry = readdir(d)) {
+            std::string name = entry->d_name;
+            struct stat st;
+            std::string path = directory_ + "/" + name;
+            if (name.find(".tmp.") != std::string::npos) {
+                // 上次退出时未完成的写入
+                unlink(path.c_str());
+            } else if (is_cache_file(name) && stat(path.c_str(), &st) == 0) {
+                disk_used_ += static_cast<size_t>(st.st_size);
+                ++files;
+            }
+        }
+        closedir(d);
+    }
+    std::cout << "[TTS缓存] 磁盘缓存 " << directory_ << ": " << files << " 条，" << disk_used_ / 1024 << " KB"
+              << std::endl;
+    if (disk_used_ > options_.disk_bytes) {
+        trim_disk();
+    }
+}
+
+void TtsCache::trim_disk() {
+    struct CacheFile {
+        std::string path;
+        size_t size;
+        struct timespec mtime;
+    };
+    std::vector<CacheFile> files;
+    size_t used = 0;
+    if (DIR* d = opendir(directory_.c_str())) {
+        while (dirent* entry = readdir(d)) {
+            std::string name = entry->d_name;
+            struct stat st;
+            std::string path = directory_ + "/" + name;
+            if (is_cache_file(name) && stat(path.c_str(), &st) == 0) {
+                files.push_back({path, static_cast<size_t>(st.st_size), st.st_mtim});
+                used += files.back().size;
+            }
+        }
+        closedir(d);
+    }
+    std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) {
+        return a.mtime.tv_sec != b.mtime.tv_sec ? a.mtime.tv_sec < b.mtime.tv_sec : a.mtime.tv_nsec < b.mtime.tv_nsec;
+    });
+    // 一次删到容量的 90%，避免此后每次写入都重新扫描目录
+    const size_t target = options_.disk_bytes / 10 * 9;
+    for (const auto& file : files) {
+        if (used <= target) {
+            break;
+        }
+        // 已映射到内存的条目不受影响，munmap 之前数据仍然可读
+        if (unlink(file.path.c_str()) == 0) {
+            used -= file.size;
+            ++disk_evictions_;
+        }
+    }
+    disk_used_ = used;
+}
+
+void TtsCache::print_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t lookups = memory_hits_ + disk_hits_ + misses_;
+    std::cout << "[TTS缓存] 查询 " << lookups << " 次，内存命中 " << memory_hits_ << "，磁盘命中 " << disk_hits_;
+    if (lookups > 0) {
+        std::cout << " (命中率 " << 100.0 * (memory_hits_ + disk_hits_) / lookups << "%)";
+    }
+    std::cout << "，省去合成 " << saved_audio_seconds_ << " 秒音频，新增 " << stores_ << " 条；内存 "
+              << memory_used_ / 1024 << " KB / " << lru_.size() << " 条";
+    if (!directory_.empty()) {
+        std::cout << "，磁盘 " << disk_used_ / 1024 << " KB，淘汰 " << disk_evictions_ << " 条";
+        if (disk_collisions_ > 0) {
+            std::cout << "，哈希冲突未写入 " << disk_collisions_ << " 条";
+        }
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,92 @@
+// tts_cache.h
+// 合成音频缓存：以“规范化文本 + 音色参数 (模型、说话人、语速)”的哈希为键缓存整段 PCM，
+// 确认语、问候语、错误提示等反复出现的文本直接播放缓存，不再合成。
+// 两级缓存：内存中按 LRU 淘汰；磁盘上每条一个文件，命中时 mmap 读取，进程重启后仍然有效，
+// 超过容量时删除最久未使用 (修改时间最早) 的文件。文件中保存完整的键，哈希冲突时按未命中处理，也不会覆盖另一个键的文件。
+#ifndef TTS_CACHE_H
+#define TTS_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct TtsCacheOptions {
+    bool enabled = true;
+    std::string directory;                      // 磁盘缓存目录，为空时使用 default_tts_cache_dir()；"none" 表示只用内存
+    size_t memory_bytes = 32u << 20;            // 内存缓存容量
+    size_t disk_bytes = 256u << 20;             // 磁盘缓存容量
+    double max_entry_seconds = 10.0;            // 超过该时长的音频不缓存 (很少重复，只会挤掉短句)
+};
+
+// ~/.cache/voice_assistant/tts (遵循 XDG_CACHE_HOME)
+std::string default_tts_cache_dir();
+
+// 去掉首尾空白并把连续空白合并为一个空格；标点影响停顿，保持不变
+std::string normalize_tts_text(const std::string& text);
+
+class TtsCache {
+public:
+    // 一条缓存的音频：采样可能位于堆上，也可能直接指向 mmap 的磁盘文件
+    class Audio {
+    public:
+        virtual ~Audio() = default;
+        const float* data() const { return data_; }
+        size_t size() const { return size_; }
+        int sample_rate() const { return sample_rate_; }
+
+    protected:
+        const float* data_ = nullptr;
+        size_t size_ = 0;
+        int sample_rate_ = 0;
+    };
+
+    // voice 标识模型与音色参数，相同文本在不同 voice 下互不命中
+    TtsCache(const TtsCacheOptions& options, std::string voice);
+
+    TtsCache(const TtsCache&) = delete;
+    TtsCache& operator=(const TtsCache&) = delete;
+
+    // 线程安全；未命中返回 nullptr
+    std::shared_ptr<const Audio> lookup(const std::string& text);
+    void store(const std::string& text, const float* samples, size_t n, int sample_rate);
+
+    void print_stats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const Audio> audio;
+    };
+
+    std::string make_key(const std::string& text) const;
+    std::string file_path(const std::string& key) const;
+    void insert_memory(const std::string& key, std::shared_ptr<const Audio> audio);
+    std::shared_ptr<const Audio> load_file(const std::string& key);
+    void write_file(const std::string& key, const float* samples, size_t n, int sample_rate);
+    void scan_disk();
+    void trim_disk();
+
+    TtsCacheOptions options_;
+    std::string voice_;
+    std::string directory_;             // 为空时不使用磁盘缓存
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;              // 表头为最近使用
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    size_t memory_used_ = 0;
+    size_t disk_used_ = 0;
+
+    uint64_t memory_hits_ = 0;
+    uint64_t disk_hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t stores_ = 0;
+    uint64_t disk_evictions_ = 0;
+    uint64_t disk_collisions_ = 0;      // 与已有文件哈希相同、未写入磁盘的条目
+    double saved_audio_seconds_ = 0.0;  // 命中所省去合成的音频时长
+};
+
+#endif // TTS_CACHE_H
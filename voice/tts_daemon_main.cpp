@@ -0,0 +1,113 @@
+// tts_daemon_main.cpp
+// 语音合成服务程序：接收 LLM 服务发来的文本块 (ZMQ REP)，用 sherpa-onnx 按句合成并播放，
+// 发布 STATUS::SPEAKING / STATUS::IDLE 与回声消除参考信号，订阅语音助手的插话打断消息。
+
+#include "tts_service.h"
+#include <atomic>
+#include <signal.h>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+std::atomic<bool> g_running(true);
+
+void signal_handler(int signal) {
+    if (signal == SIGINT || signal == SIGTERM) {
+        std::cout << "\n\n程序被用户中断" << std::endl;
+        g_running = false;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    TtsOptions options;
+    options.model_dir = "./models/vits-zh-aishell3";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--model-dir" && i + 1 < argc) {
+            options.model_dir = argv[++i];
+        } else if (arg == "--model" && i + 1 < argc) {
+            options.model = argv[++i];
+        } else if (arg == "--tokens" && i + 1 < argc) {
+            options.tokens = argv[++i];
+        } else if (arg == "--lexicon" && i + 1 < argc) {
+            options.lexicon = argv[++i];
+        } else if (arg == "--data-dir" && i + 1 < argc) {
+            options.data_dir = argv[++i];
+        } else if (arg == "--dict-dir" && i + 1 < argc) {
+            options.dict_dir = argv[++i];
+        } else if (arg == "--rule-fsts" && i + 1 < argc) {
+            options.rule_fsts = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.num_threads = std::stoi(argv[++i]);
+        } else if (arg == "--sid" && i + 1 < argc) {
+            options.speaker_id = std::stoi(argv[++i]);
+        } else if (arg == "--speed" && i + 1 < argc) {
+            options.speed = std::stof(argv[++i]);
+        } else if (arg == "--device" && i + 1 < argc) {
+            options.device_idx = std::stoi(argv[++i]);
+        } else if (arg == "--bind" && i + 1 < argc) {
+            options.bind_address = argv[++i];
+        } else if (arg == "--status-pub" && i + 1 < argc) {
+            options.status_address = argv[++i];
+        } else if (arg == "--control-sub" && i + 1 < argc) {
+            options.control_address = argv[++i];
+        } else if (arg == "--no-control") {
+            options.control_address.clear();
+        } else if (arg == "--no-reference") {
+            options.publish_reference = false;
+        } else if (arg == "--no-cache") {
+            options.cache.enabled = false;
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            options.cache.directory = argv[++i];
+        } else if (arg == "--cache-mb" && i + 1 < argc) {
+            options.cache.memory_bytes = std::stoul(argv[++i]) << 20;
+        } else if (arg == "--cache-disk-mb" && i + 1 < argc) {
+            options.cache.disk_bytes = std::stoul(argv[++i]) << 20;
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "用法: " << argv[0] << " [选项]" << std::endl;
+            std::cout << "选项:" << std::endl;
+            std::cout << "  --model-dir DIR            TTS模型目录 (默认 ./models/vits-zh-aishell3)" << std::endl;
+            std::cout << "  --model PATH               模型文件 (默认为模型目录下第一个 *.onnx)" << std::endl;
+            std::cout << "  --tokens PATH              tokens.txt (默认在模型目录下)" << std::endl;
+            std::cout << "  --lexicon PATH             lexicon.txt (默认在模型目录下查找)" << std::endl;
+            std::cout << "  --data-dir DIR             espeak-ng-data 目录 (piper 等模型)" << std::endl;
+            std::cout << "  --dict-dir DIR             jieba 词典目录" << std::endl;
+            std::cout << "  --rule-fsts LIST           文本正则化规则，逗号分隔 (默认为模型目录下的 *.fst)" << std::endl;
+            std::cout << "  --threads N                推理线程数 (默认 2)" << std::endl;
+            std::cout << "  --sid N                    说话人编号 (默认 0)" << std::endl;
+            std::cout << "  --speed X                  语速 (默认 1.0)" << std::endl;
+            std::cout << "  --device N                 输出设备索引 (默认为系统默认设备)" << std::endl;
+            std::cout << "  --bind ADDR                接收文本的地址 (默认 tcp://*:7777)" << std::endl;
+            std::cout << "  --status-pub ADDR          发布状态与参考信号的地址 (默认 tcp://*:6677)" << std::endl;
+            std::cout << "  --control-sub ADDR         订阅插话打断消息的地址 (默认 tcp://localhost:6690)" << std::endl;
+            std::cout << "  --no-control               不订阅插话打断消息" << std::endl;
+            std::cout << "  --no-reference             不发布回声消除参考信号 (TTS::PCM)" << std::endl;
+            std::cout << "  --no-cache                 不使用合成音频缓存" << std::endl;
+            std::cout << "  --cache-dir DIR            磁盘缓存目录，none 表示只用内存 (默认 ~/.cache/voice_assistant/tts)" << std::endl;
+            std::cout << "  --cache-mb N               内存缓存容量 MB (默认 32)" << std::endl;
+            std::cout << "  --cache-disk-mb N          磁盘缓存容量 MB (默认 256)" << std::endl;
+            std::cout << "  --help, -h                 显示此帮助信息" << std::endl;
+            return 0;
+        }
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    std::unique_ptr<TtsService> service;
+    try {
+        service = std::make_unique<TtsService>(options);
+    } catch (const std::exception& e) {
+        std::cerr << "错误：" << e.what() << std::endl;
+        return -1;
+    }
+    service->run(g_running);
+    service->print_stats();
+    return 0;
+}
@@ -0,0 +1,410 @@
+// tts_service.cpp
+// 语音合成服务：文本队列 → 合成线程 (按句) → 音频队列 → 播放线程
+
+#include "tts_service.h"
+#include "asr_model.h"
+#include "control_message.h"
+#include "echo_reference.h"
+#include "sys_util.h"
+#include "ZmqServer.h"
+#include "ZmqSubscriber.h"
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <sys/stat.h>
+
+using namespace sherpa_onnx::cxx;
+
+namespace {
+
+bool directory_exists(const std::string& path) {
+    struct stat st;
+    return !path.empty() && stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// 目录中以 suffix 结尾的文件 (按文件名排序)
+std::vector<std::string> files_with_suffix(const std::string& dir, const std::string& suffix) {
+    std::vector<std::string> names;
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* entry = readdir(d)) {
+            std::string name = entry->d_name;
+            if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                names.push_back(name);
+            }
+        }
+        closedir(d);
+    }
+    std::sort(names.begin(), names.end());
+    for (auto& name : names) {
+        name = dir + "/" + name;
+    }
+    return names;
+}
+
+// VITS 系列模型 (piper、vits-zh-aishell3 等) 的目录布局：模型文件名各不相同，按后缀查找
+OfflineTtsConfig make_offline_tts_config(const TtsOptions& options) {
+    const std::string& dir = options.model_dir;
+    OfflineTtsConfig config;
+    auto& vits = config.model.vits;
+    vits.model = options.model;
+    if (vits.model.empty()) {
+        auto models = files_with_suffix(dir, ".onnx");
+        if (!models.empty()) {
+            vits.model = models.front();
+        }
+    }
+    vits.tokens = options.tokens.empty() ? dir + "/tokens.txt" : options.tokens;
+    vits.lexicon = options.lexicon;
+    if (vits.lexicon.empty() && model_file_exists(dir + "/lexicon.txt")) {
+        vits.lexicon = dir + "/lexicon.txt";
+    }
+    vits.data_dir = options.data_dir;
+    if (vits.data_dir.empty() && directory_exists(dir + "/espeak-ng-data")) {
+        vits.data_dir = dir + "/espeak-ng-data";
+    }
+    vits.dict_dir = options.dict_dir;
+    if (vits.dict_dir.empty() && directory_exists(dir + "/dict")) {
+        vits.dict_dir = dir + "/dict";
+    }
+    config.rule_fsts = options.rule_fsts;
+    if (config.rule_fsts.empty()) {
+        for (const auto& fst : files_with_suffix(dir, ".fst")) {
+            config.rule_fsts += (config.rule_fsts.empty() ? "" : ",") + fst;
+        }
+    }
+    config.model.num_threads = options.num_threads;
+    // 每句合成完即回调，第一句就能开始播放
+    config.max_num_sentences = 1;
+    return config;
+}
+
+// 缓存键中的音色部分：模型文件 (含大小与修改时间，替换模型后旧缓存自然失效)、文本前端配置、说话人与语速
+std::string voice_identity(const OfflineTtsConfig& config, const TtsOptions& options, int sample_rate) {
+    const auto& vits = config.model.vits;
+    std::string identity = vits.model;
+    struct stat st;
+    if (stat(vits.model.c_str(), &st) == 0) {
+        identity += ":" + std::to_string(st.st_size) + ":" + std::to_string(st.st_mtime);
+    }
+    identity += "|" + vits.lexicon + "|" + vits.data_dir + "|" + vits.dict_dir + "|" + config.rule_fsts;
+    identity += "|sid=" + std::to_string(options.speaker_id) + "|speed=" + std::to_string(options.speed) +
+                "|sr=" + std::to_string(sample_rate);
+    return identity;
+}
+
+// 进程的常驻内存峰值 (MB)，读取失败时返回 0
+double peak_rss_mb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::stod(line.substr(6)) / 1024.0;
+        }
+    }
+    return 0.0;
+}
+
+} // namespace
+
+TtsService::TtsService(const TtsOptions& options)
+    : options_(options),
+      publisher_(options.status_address)
+{
+    OfflineTtsConfig config = make_offline_tts_config(options_);
+    if (!model_file_exists(config.model.vits.model) || !model_file_exists(config.model.vits.tokens)) {
+        throw std::runtime_error("在 " + options_.model_dir + " 中找不到TTS模型 (*.onnx) 或 tokens.txt");
+    }
+    auto start = Clock::now();
+    tts_ = std::make_unique<OfflineTts>(OfflineTts::Create(config));
+    if (!tts_->Get()) {
+        throw std::runtime_error("TTS模型加载失败: " + config.model.vits.model);
+    }
+    sample_rate_ = tts_->SampleRate();
+    std::cout << "[TTS] 模型 " << config.model.vits.model << " 加载完成，耗时 "
+              << std::chrono::duration<double, std::milli>(Clock::now() - start).count() << " ms，采样率 "
+              << sample_rate_ << "，说话人 " << options_.speaker_id << "/" << tts_->NumSpeakers() << std::endl;
+    if (options_.cache.enabled) {
+        cache_ = std::make_unique<TtsCache>(options_.cache, voice_identity(config, options_, sample_rate_));
+    }
+
+    sink_ = std::make_unique<PortAudioSink>(options_.device_idx, sample_rate_);
+    if (!sink_->start()) {
+        throw std::runtime_error("无法打开音频输出设备");
+    }
+    synthesis_thread_ = std::thread(&TtsService::synthesis_loop, this);
+    playback_thread_ = std::thread(&TtsService::playback_loop, this);
+}
+
+TtsService::~TtsService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        ++epoch_;
+    }
+    text_ready_.notify_all();
+    audio_ready_.notify_all();
+    if (synthesis_thread_.joinable()) {
+        synthesis_thread_.join();
+    }
+    if (playback_thread_.joinable()) {
+        playback_thread_.join();
+    }
+    sink_->stop();
+}
+
+void TtsService::run(const std::atomic<bool>& running) {
+    zmq_component::ZmqServer server(options_.bind_address);
+    std::unique_ptr<zmq_component::ZmqSubscriber> control;
+    if (!options_.control_address.empty()) {
+        control = std::make_unique<zmq_component::ZmqSubscriber>(options_.control_address, kControlPrefix);
+    }
+    std::cout << "[TTS] 服务已启动" << std::endl;
+    std::cout << "  -> 文本 " << options_.bind_address << " (REP)" << std::endl;
+    std::cout << "  -> 状态" << (options_.publish_reference ? "/播放参考信号 " : " ") << options_.status_address
+              << " (PUB)" << std::endl;
+    if (control) {
+        std::cout << "  -> 控制消息 " << options_.control_address << " (SUB)" << std::endl;
+    }
+    std::cout << "[TTS] 常驻内存 " << peak_rss_mb() << " MB" << std::endl;
+
+    std::vector<zmq::pollitem_t> items = {{server.socket().handle(), 0, ZMQ_POLLIN, 0}};
+    if (control) {
+        items.push_back({control->socket().handle(), 0, ZMQ_POLLIN, 0});
+    }
+    while (running) {
+        try {
+            zmq::poll(items.data(), items.size(), std::chrono::milliseconds(100));
+        } catch (const zmq::error_t& e) {
+            if (e.num() == EINTR) {
+                continue;
+            }
+            throw;
+        }
+        if (items[0].revents & ZMQ_POLLIN) {
+            std::string text = server.receive();
+            // 立即回复，LLM 服务不必等待合成
+            server.send("OK");
+            std::cout << "[llm -> tts] 收到: " << text << std::endl;
+            submit(std::move(text));
+        }
+        if (control && (items[1].revents & ZMQ_POLLIN)) {
+            std::string message;
+            while (control->tryReceive(message)) {
+                std::string session;
+                uint64_t utterance_id = 0;
+                if (parse_cancel_message(message, session, utterance_id)) {
+                    std::cout << "[TTS] 用户插话 (会话 " << session << "，句子 " << utterance_id << ")，停止播放"
+                              << std::endl;
+                    cancel();
+                }
+            }
+        }
+    }
+}
+
+void TtsService::submit(std::string text) {
+    if (text.find_first_not_of(" \t\r\n") == std::string::npos) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++texts_received_;
+        texts_.push_back({std::move(text), epoch_, Clock::now()});
+    }
+    text_ready_.notify_one();
+}
+
+void TtsService::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++epoch_;
+        ++cancels_;
+        texts_.clear();
+        audio_.clear();
+    }
+    // 正在进行的合成在下一句回调时停止，正在播放的音频在当前 20ms 片段之后停止
+    audio_ready_.notify_all();
+}
+
+void TtsService::synthesis_loop() {
+    while (true) {
+        TextJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            text_ready_.wait(lock, [this] { return stopping_ || !texts_.empty(); });
+            if (stopping_) {
+                break;
+            }
+            job = std::move(texts_.front());
+            texts_.pop_front();
+            synthesizing_ = true;
+        }
+        if (job.epoch == epoch_) {
+            synthesize(job);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            synthesizing_ = false;
+        }
+        audio_ready_.notify_all();
+    }
+}
+
+void TtsService::synthesize(const TextJob& job) {
+    if (cache_) {
+        if (auto cached = cache_->lookup(job.text)) {
+            // 命中：整段音频作为一块直接交给播放线程，不调用模型
+            push_audio(cached->data(), cached->size(), job, true);
+            return;
+        }
+    }
+    SentenceContext context{this, &job, true, 0};
+    auto start = Clock::now();
+    GeneratedAudio audio = tts_->Generate(job.text, options_.speaker_id, options_.speed,
+                                          &TtsService::on_sentence, &context);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    // 被取消时只合成了一部分，不能缓存
+    if (cache_ && job.epoch == epoch_) {
+        cache_->store(job.text, audio.samples.data(), audio.samples.size(), sample_rate_);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    sentences_ += context.sentences;
+    synthesis_seconds_ += seconds;
+    synthesized_audio_seconds_ += static_cast<double>(audio.samples.size()) / sample_rate_;
+}
+
+int32_t TtsService::on_sentence(const float* samples, int32_t n, float /*progress*/, void* arg) {
+    auto* context = static_cast<SentenceContext*>(arg);
+    if (context->job->epoch != context->self->epoch_) {
+        // 已被取消：返回 0 让 OfflineTts 不再合成后面的句子
+        return 0;
+    }
+    context->self->push_audio(samples, static_cast<size_t>(n), *context->job, context->first);
+    context->first = false;
+    ++context->sentences;
+    return 1;
+}
+
+void TtsService::push_audio(const float* samples, size_t n, const TextJob& job, bool first) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (job.epoch != epoch_) {
+            return;
+        }
+        AudioChunk chunk;
+        chunk.samples.assign(samples, samples + n);
+        chunk.epoch = job.epoch;
+        chunk.received = job.received;
+        chunk.first = first;
+        audio_.push_back(std::move(chunk));
+        if (first) {
+            first_sentence_.add(std::chrono::duration<double, std::milli>(Clock::now() - job.received).count());
+        }
+    }
+    audio_ready_.notify_one();
+}
+
+void TtsService::playback_loop() {
+    bool speaking = false;
+    while (true) {
+        AudioChunk chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // 文本、合成和音频都处理完才算空闲；下一句还在合成时保持 SPEAKING，识别端不会在句间误开麦
+            audio_ready_.wait(lock, [this, speaking] {
+                return stopping_ || !audio_.empty() || (speaking && texts_.empty() && !synthesizing_);
+            });
+            if (stopping_) {
+                break;
+            }
+            if (audio_.empty()) {
+                // 等输出缓冲区里的音频真正播完再发 IDLE，期间有新文本或音频到达则继续保持 SPEAKING
+                auto remaining = std::chrono::microseconds(std::max<int64_t>(0, sink_->next_play_time_us() - now_us()));
+                if (audio_ready_.wait_for(lock, remaining, [this] {
+                        return stopping_ || !audio_.empty() || !texts_.empty() || synthesizing_;
+                    })) {
+                    continue;
+                }
+                lock.unlock();
+                publish_status(false);
+                speaking = false;
+                continue;
+            }
+            chunk = std::move(audio_.front());
+            audio_.pop_front();
+        }
+        if (chunk.epoch != epoch_) {
+            continue;
+        }
+        if (!speaking) {
+            publish_status(true);
+            speaking = true;
+        }
+        if (chunk.first) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            first_audio_.add(std::chrono::duration<double, std::milli>(Clock::now() - chunk.received).count());
+        }
+        play(chunk);
+    }
+    if (speaking) {
+        publish_status(false);
+    }
+}
+
+void TtsService::play(const AudioChunk& chunk) {
+    // 按 20ms 分片写入：取消能在一个分片内生效，参考信号也按分片带上各自的播放时刻
+    const size_t slice = static_cast<size_t>(sample_rate_ / 50);
+    for (size_t offset = 0; offset < chunk.samples.size(); offset += slice) {
+        if (chunk.epoch != epoch_) {
+            sink_->flush();
+            return;
+        }
+        size_t n = std::min(slice, chunk.samples.size() - offset);
+        const float* samples = chunk.samples.data() + offset;
+        if (options_.publish_reference) {
+            // 先发布再写入：参考信号必须早于回声到达识别端
+            reference_scratch_.resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                float s = std::max(-1.0f, std::min(1.0f, samples[i]));
+                reference_scratch_[i] = static_cast<int16_t>(s * 32767.0f);
+            }
+            try {
+                publisher_.publish(kPcmTopic, encode_pcm_message(reference_scratch_.data(), n, sample_rate_,
+                                                                 sink_->next_play_time_us()));
+            } catch (const zmq_component::ZmqCommunicationError& e) {
+                std::cerr << "[TTS] 发布参考信号失败: " << e.what() << std::endl;
+            }
+        }
+        if (!sink_->write(samples, n)) {
+            std::cerr << "[TTS] 写入音频输出失败" << std::endl;
+            return;
+        }
+    }
+}
+
+void TtsService::publish_status(bool speaking) {
+    const char* status = speaking ? "STATUS::SPEAKING" : "STATUS::IDLE";
+    try {
+        publisher_.publish(status);
+        std::cout << "[Status PUB] 已发送: " << status << std::endl;
+    } catch (const zmq_component::ZmqCommunicationError& e) {
+        std::cerr << "[TTS] 发布状态失败: " << e.what() << std::endl;
+    }
+}
+
+void TtsService::print_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::cout << "[TTS] 收到文本 " << texts_received_ << " 段，合成 " << sentences_ << " 句，被打断 " << cancels_
+              << " 次";
+    if (synthesized_audio_seconds_ > 0.0) {
+        std::cout << "，合成实时率 " << synthesis_seconds_ / synthesized_audio_seconds_;
+    }
+    std::cout << "，常驻内存峰值 " << peak_rss_mb() << " MB" << std::endl;
+    first_sentence_.print();
+    first_audio_.print();
+    if (cache_) {
+        cache_->print_stats();
+    }
+}
@@ -0,0 +1,132 @@
+// tts_service.h
+// 语音合成服务：经 ZMQ REP 接收 LLM 服务发来的文本块，用 sherpa-onnx OfflineTts 合成并在本机播放，
+// 与原 TTS 服务的接口兼容 (数据端口回复 "OK"，状态端口发布 STATUS::SPEAKING / STATUS::IDLE)。
+// 合成线程与播放线程之间是音频队列：按句回调，第一句合成完即开始播放，下一句 (及下一个文本块) 在播放期间合成。
+// 同一 PUB 端口还发布实际播放的 PCM (TTS::PCM，见 echo_reference.h) 作为识别端回声消除的参考；
+// 订阅语音助手的 CONTROL::CANCEL 后，用户插话时立即停止合成并丢弃尚未播放的音频。
+// 合成前先查询音频缓存 (见 tts_cache.h)，重复的文本不再合成。
+#ifndef TTS_SERVICE_H
+#define TTS_SERVICE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sherpa-onnx/c-api/cxx-api.h>
+#include "latency_stats.h"
+#include "portaudio_sink.h"
+#include "tts_cache.h"
+#include "ZmqPublisher.h"
+
+struct TtsOptions {
+    // 模型目录：自动查找其中的 *.onnx、tokens.txt、lexicon.txt、espeak-ng-data、dict 以及文本正则化的 *.fst；
+    // 以下各项非空时覆盖自动查找的结果
+    std::string model_dir;
+    std::string model;
+    std::string tokens;
+    std::string lexicon;
+    std::string data_dir;
+    std::string dict_dir;
+    std::string rule_fsts;
+
+    int num_threads = 2;
+    int speaker_id = 0;
+    float speed = 1.0f;
+    int device_idx = -1;                                    // 输出设备，-1 为默认设备
+
+    std::string bind_address = "tcp://*:7777";              // 文本 (REP)
+    std::string status_address = "tcp://*:6677";            // 状态与参考信号 (PUB)
+    std::string control_address = "tcp://localhost:6690";   // 语音助手的控制消息 (SUB)，为空时不订阅
+    bool publish_reference = true;                          // 发布 TTS::PCM 供回声消除使用
+
+    TtsCacheOptions cache;                                  // 重复文本直接播放缓存的音频
+};
+
+class TtsService {
+public:
+    // 加载模型、打开输出设备并启动合成/播放线程，失败时抛出 std::runtime_error
+    explicit TtsService(const TtsOptions& options);
+    ~TtsService();
+
+    TtsService(const TtsService&) = delete;
+    TtsService& operator=(const TtsService&) = delete;
+
+    // 接收文本与控制消息直到 running 变为 false
+    void run(const std::atomic<bool>& running);
+
+    // 线程安全
+    void submit(std::string text);
+    // 停止合成，丢弃所有尚未播放的文本和音频
+    void cancel();
+
+    void print_stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct TextJob {
+        std::string text;
+        uint64_t epoch = 0;
+        Clock::time_point received;
+    };
+
+    struct AudioChunk {
+        std::vector<float> samples;
+        uint64_t epoch = 0;
+        Clock::time_point received;
+        bool first = false;             // 该文本块的第一句
+    };
+
+    // OfflineTts 按句回调的上下文
+    struct SentenceContext {
+        TtsService* self;
+        const TextJob* job;
+        bool first;
+        uint64_t sentences;
+    };
+
+    static int32_t on_sentence(const float* samples, int32_t n, float progress, void* arg);
+    void synthesis_loop();
+    void playback_loop();
+    void synthesize(const TextJob& job);
+    void push_audio(const float* samples, size_t n, const TextJob& job, bool first);
+    void play(const AudioChunk& chunk);
+    void publish_status(bool speaking);
+
+    TtsOptions options_;
+    std::unique_ptr<sherpa_onnx::cxx::OfflineTts> tts_;
+    int sample_rate_ = 0;
+    std::unique_ptr<TtsCache> cache_;       // 只在合成线程中查询和写入
+    std::unique_ptr<PortAudioSink> sink_;   // 采样率取决于模型，加载后创建
+    // 只在播放线程中使用
+    zmq_component::ZmqPublisher publisher_;
+    std::vector<int16_t> reference_scratch_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable text_ready_;
+    std::condition_variable audio_ready_;
+    std::deque<TextJob> texts_;
+    std::deque<AudioChunk> audio_;
+    bool synthesizing_ = false;
+    bool stopping_ = false;
+    std::atomic<uint64_t> epoch_{0};    // 每次取消加一，旧的文本和音频随之作废
+    std::thread synthesis_thread_;
+    std::thread playback_thread_;
+
+    // 统计 (受 mutex_ 保护)
+    uint64_t texts_received_ = 0;
+    uint64_t sentences_ = 0;
+    uint64_t cancels_ = 0;
+    double synthesis_seconds_ = 0.0;
+    double synthesized_audio_seconds_ = 0.0;
+    LatencyStats first_audio_{"收到文本→开始播放"};
+    LatencyStats first_sentence_{"收到文本→第一句合成完成"};
+};
+
+#endif // TTS_SERVICE_H
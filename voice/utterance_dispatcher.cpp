@@ -0,0 +1,266 @@
+// utterance_dispatcher.cpp
+// 有界识别结果队列 + 分发线程
+
+#include "utterance_dispatcher.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+Speculation::State Speculation::state() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_;
+}
+
+Speculation::State Speculation::wait() const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    resolved_.wait(lock, [this] { return state_ != State::Pending; });
+    return state_;
+}
+
+std::chrono::steady_clock::time_point Speculation::resolved_at() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return resolved_at_;
+}
+
+void Speculation::resolve(State state) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ != State::Pending) {
+            return;
+        }
+        state_ = state;
+        resolved_at_ = std::chrono::steady_clock::now();
+    }
+    resolved_.notify_all();
+}
+
+UtteranceDispatcher::UtteranceDispatcher(size_t capacity, QueueFullPolicy policy, Handler handler,
+                                         std::string coalesce_separator)
+    : capacity_(std::max<size_t>(capacity, 1)),
+      policy_(policy),
+      handler_(std::move(handler)),
+      coalesce_separator_(std::move(coalesce_separator))
+{
+}
+
+UtteranceDispatcher::~UtteranceDispatcher() {
+    stop();
+}
+
+bool UtteranceDispatcher::parse_policy(const std::string& name, QueueFullPolicy& policy) {
+    if (name == "coalesce") {
+        policy = QueueFullPolicy::Coalesce;
+    } else if (name == "drop-oldest") {
+        policy = QueueFullPolicy::DropOldest;
+    } else if (name == "block") {
+        policy = QueueFullPolicy::Block;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void UtteranceDispatcher::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (worker_.joinable()) {
+        return;
+    }
+    stopping_ = false;
+    worker_ = std::thread(&UtteranceDispatcher::run, this);
+}
+
+void UtteranceDispatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        // 正在等待最终文本的推测请求不会再被确认
+        if (speculation_) {
+            speculation_->resolve(Speculation::State::Cancelled);
+            speculation_.reset();
+        }
+        queued_speculation_.reset();
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+    if (worker_.joinable()) {
+        // 处理函数可能正阻塞在远端请求上 (超时可达十几秒)，先中止它再等待
+        if (interrupt_handler_) {
+            interrupt_handler_();
+        }
+        worker_.join();
+    }
+}
+
+bool UtteranceDispatcher::submit(std::string text) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_) {
+        return false;
+    }
+    ++submitted_;
+
+    if (speculation_) {
+        auto speculation = std::move(speculation_);
+        if (text == speculation_text_) {
+            // 命中：推测请求即是这句话的请求 (若尚未发出，分发线程稍后照常发送)
+            speculation->resolve(Speculation::State::Committed);
+            ++speculation_hits_;
+            ++dispatched_;
+            speculation_lead_.add(speculation_sent_
+                                      ? std::chrono::duration<double, std::milli>(
+                                            speculation->resolved_at() - speculation_sent_at_).count()
+                                      : 0.0);
+            return true;
+        }
+        speculation->resolve(Speculation::State::Cancelled);
+        ++speculation_misses_;
+        if (queued_speculation_ == speculation) {
+            queued_speculation_.reset();
+        }
+        if (speculation_sent_ && discard_handler_) {
+            discard_handler_(*speculation);
+        }
+    }
+
+    if (queue_.size() >= capacity_) {
+        switch (policy_) {
+        case QueueFullPolicy::Coalesce:
+            queue_.back() += coalesce_separator_ + text;
+            ++coalesced_;
+            std::cout << "[Dispatch] 队列已满，合并到上一句: " << queue_.back() << std::endl;
+            return true;
+        case QueueFullPolicy::DropOldest:
+            std::cout << "[Dispatch] 队列已满，丢弃最早的一句: " << queue_.front() << std::endl;
+            queue_.pop_front();
+            ++dropped_;
+            break;
+        case QueueFullPolicy::Block:
+            ++blocked_;
+            not_full_.wait(lock, [this] { return stopping_ || queue_.size() < capacity_; });
+            if (stopping_) {
+                return false;
+            }
+            break;
+        }
+    }
+
+    queue_.push_back(std::move(text));
+    max_depth_ = std::max(max_depth_, queue_.size());
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+}
+
+bool UtteranceDispatcher::speculate(const std::string& text) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_ || !speculative_handler_) {
+        return false;
+    }
+    if (speculation_ && text == speculation_text_) {
+        return true;
+    }
+    // 上一句的回复还在处理中：推测请求只会排在其后，不如等最终文本
+    if (!queue_.empty() || (busy_ && !busy_speculating_)) {
+        ++speculations_skipped_;
+        return false;
+    }
+    if (speculation_) {
+        // 中间结果又变了：取消此前的推测，已发出的请求通知远端停止
+        speculation_->resolve(Speculation::State::Cancelled);
+        ++speculations_superseded_;
+        if (speculation_sent_ && discard_handler_) {
+            discard_handler_(*speculation_);
+        }
+    }
+    speculation_ = std::make_shared<Speculation>();
+    speculation_->id_ = ++speculations_;
+    speculation_text_ = text;
+    speculation_sent_ = false;
+    queued_speculation_ = speculation_;
+    queued_speculation_text_ = text;
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+}
+
+size_t UtteranceDispatcher::cancel_pending() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t count = queue_.size();
+    queue_.clear();
+    cancelled_ += count;
+    if (speculation_) {
+        speculation_->resolve(Speculation::State::Cancelled);
+        speculation_.reset();
+    }
+    queued_speculation_.reset();
+    lock.unlock();
+    not_full_.notify_all();
+    return count;
+}
+
+size_t UtteranceDispatcher::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void UtteranceDispatcher::run() {
+    while (true) {
+        std::string text;
+        std::shared_ptr<Speculation> speculation;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this] { return stopping_ || !queue_.empty() || queued_speculation_; });
+            if (stopping_) {
+                break;
+            }
+            if (!queue_.empty()) {
+                text = std::move(queue_.front());
+                queue_.pop_front();
+                ++dispatched_;
+            } else {
+                speculation = std::move(queued_speculation_);
+                text = std::move(queued_speculation_text_);
+                if (speculation == speculation_) {
+                    speculation_sent_ = true;
+                    speculation_sent_at_ = std::chrono::steady_clock::now();
+                }
+            }
+            busy_ = true;
+            busy_speculating_ = speculation != nullptr;
+        }
+        not_full_.notify_one();
+
+        bool stopped = false;
+        try {
+            if (speculation) {
+                stopped = speculative_handler_(text, *speculation) &&
+                          speculation->state() == Speculation::State::Cancelled;
+            } else {
+                handler_(text);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[Dispatch] 处理识别结果时出错: " << e.what() << std::endl;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped) {
+            ++speculations_stopped_;
+        }
+        busy_ = false;
+        busy_speculating_ = false;
+    }
+}
+
+void UtteranceDispatcher::print_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::cout << "[Dispatch] 提交 " << submitted_ << " 句，已分发 " << dispatched_
+              << "，合并 " << coalesced_ << "，丢弃 " << dropped_
+              << "，打断时取消 " << cancelled_ << "，阻塞 " << blocked_ << " 次，最大队列深度 " << max_depth_
+              << "，剩余 " << queue_.size() << std::endl;
+    if (speculative_handler_) {
+        uint64_t resolved = speculation_hits_ + speculation_misses_;
+        std::cout << "[Speculate] 推测请求 " << speculations_ << " 次 (被更新的中间结果取代 " << speculations_superseded_
+                  << "，分发线程忙而未推测 " << speculations_skipped_ << ")，命中 " << speculation_hits_ << "，未命中 "
+                  << speculation_misses_ << "，命中率 " << (resolved ? 100.0 * speculation_hits_ / resolved : 0.0)
+                  << "%，已发出后取消且远端确认停止 " << speculations_stopped_ << std::endl;
+        speculation_lead_.print();
+    }
+}
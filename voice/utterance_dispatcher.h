@@ -0,0 +1,139 @@
+// utterance_dispatcher.h
+// 识别结果分发队列：采集/识别线程只负责入队，独立的分发线程负责调用远端 (LLM)，
+// 远端再慢也不会阻塞音频采集。
+// 推测发送：中间结果稳定后可先登记一次推测请求，分发线程空闲时立即发出，远端先生成、暂不输出；
+// 最终文本与推测文本相同即确认 (命中)，由推测处理函数通知远端输出，省掉生成的等待；
+// 不同则取消推测请求 (通知远端停止)，照常发送最终文本。
+#ifndef UTTERANCE_DISPATCHER_H
+#define UTTERANCE_DISPATCHER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "latency_stats.h"
+
+// 队列满时的处理策略
+enum class QueueFullPolicy {
+    Coalesce,    // 合并到队尾的上一句中，一次性发送
+    DropOldest,  // 丢弃最早的一句
+    Block        // 阻塞提交方直到有空位 (会反压采集线程)
+};
+
+// 一次推测请求的状态：最终文本到达前为 Pending，与推测文本相同则为 Committed，否则为 Cancelled
+class Speculation {
+public:
+    enum class State { Pending, Committed, Cancelled };
+
+    // 推测编号，从 1 开始递增，用于通知远端确认或丢弃
+    uint64_t id() const { return id_; }
+    State state() const;
+    // 阻塞直到状态确定
+    State wait() const;
+    // 状态确定的时刻 (命中时即最终文本到达的时刻)
+    std::chrono::steady_clock::time_point resolved_at() const;
+
+private:
+    friend class UtteranceDispatcher;
+    void resolve(State state);
+
+    uint64_t id_ = 0;
+    mutable std::mutex mutex_;
+    mutable std::condition_variable resolved_;
+    State state_ = State::Pending;
+    std::chrono::steady_clock::time_point resolved_at_;
+};
+
+class UtteranceDispatcher {
+public:
+    using Handler = std::function<void(const std::string&)>;
+    // 处理推测请求：发送 text，须在状态确定后才返回；命中时由它完成这句话的请求。
+    // 返回远端是否已回复该推测请求 (取消时即远端已停止)，请求失败返回 false
+    using SpeculativeHandler = std::function<bool(const std::string& text, const Speculation& speculation)>;
+    // 已发出的推测请求未命中或被取代时调用，用于通知远端停止；在 submit()/speculate() 中持锁调用，须快速返回
+    using DiscardHandler = std::function<void(const Speculation& speculation)>;
+
+    UtteranceDispatcher(size_t capacity, QueueFullPolicy policy, Handler handler,
+                        std::string coalesce_separator = "，");
+    ~UtteranceDispatcher();
+
+    UtteranceDispatcher(const UtteranceDispatcher&) = delete;
+    UtteranceDispatcher& operator=(const UtteranceDispatcher&) = delete;
+
+    void start();
+    // 停止分发线程：先调用中断函数让正在处理的一句尽快结束 (未设置时等待其完成)，丢弃尚未处理的句子
+    void stop();
+
+    // 启用推测发送，须在 start() 之前调用
+    void set_speculative_handler(SpeculativeHandler handler) { speculative_handler_ = std::move(handler); }
+    void set_discard_handler(DiscardHandler handler) { discard_handler_ = std::move(handler); }
+    // stop() 在等待分发线程之前调用，用于中止正在进行的远端请求 (须线程安全)；须在 start() 之前调用
+    void set_interrupt_handler(std::function<void()> handler) { interrupt_handler_ = std::move(handler); }
+
+    // 线程安全。Block 策略下可能阻塞；停止后返回 false。
+    // 与尚未确定的推测请求文本相同时直接确认该请求，不再入队
+    bool submit(std::string text);
+
+    // 线程安全。登记一次推测请求 (取代同一句中此前的推测)；
+    // 分发线程正在处理最终文本或队列非空时不推测，返回 false
+    bool speculate(const std::string& text);
+
+    // 线程安全。丢弃尚未处理的句子并取消推测请求 (用户打断时调用)，返回丢弃的句数。
+    // 正在处理的一句由处理函数自行中止
+    size_t cancel_pending();
+
+    size_t pending() const;
+    void print_stats() const;
+
+    static bool parse_policy(const std::string& name, QueueFullPolicy& policy);
+
+private:
+    void run();
+
+    size_t capacity_;
+    QueueFullPolicy policy_;
+    Handler handler_;
+    std::string coalesce_separator_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<std::string> queue_;
+    bool stopping_ = false;
+    std::thread worker_;
+
+    SpeculativeHandler speculative_handler_;
+    DiscardHandler discard_handler_;
+    std::function<void()> interrupt_handler_;
+    std::shared_ptr<Speculation> speculation_;          // 尚未确定的推测请求
+    std::string speculation_text_;
+    std::shared_ptr<Speculation> queued_speculation_;   // 已登记、分发线程尚未发出
+    std::string queued_speculation_text_;
+    bool speculation_sent_ = false;                     // speculation_ 是否已由分发线程发出
+    std::chrono::steady_clock::time_point speculation_sent_at_;
+    bool busy_ = false;
+    bool busy_speculating_ = false;
+
+    // 统计 (受 mutex_ 保护)
+    uint64_t submitted_ = 0;
+    uint64_t dispatched_ = 0;
+    uint64_t coalesced_ = 0;
+    uint64_t dropped_ = 0;
+    uint64_t blocked_ = 0;
+    uint64_t cancelled_ = 0;
+    size_t max_depth_ = 0;
+    uint64_t speculations_ = 0;
+    uint64_t speculation_hits_ = 0;
+    uint64_t speculation_misses_ = 0;
+    uint64_t speculations_superseded_ = 0;
+    uint64_t speculations_skipped_ = 0;
+    uint64_t speculations_stopped_ = 0;     // 取消后远端已回复 (确认停止) 的推测请求
+    LatencyStats speculation_lead_{"推测请求领先最终文本"};
+};
+
+#endif // UTTERANCE_DISPATCHER_H
@@ -0,0 +1,221 @@
+// vad_gate.cpp
+// VAD 前置能量/过零率门限，特征计算使用 SSE2 (x86-64) 或 NEON (aarch64)
+
+#include "vad_gate.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+float sum_squares(const float* x, size_t n) {
+    size_t i = 0;
+    float sum = 0.0f;
+#if defined(__SSE2__)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        __m128 a = _mm_loadu_ps(x + i);
+        __m128 b = _mm_loadu_ps(x + i + 4);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(a, a));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(b, b));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vld1q_f32(x + i);
+        float32x4_t b = vld1q_f32(x + i + 4);
+        acc0 = vfmaq_f32(acc0, a, a);
+        acc1 = vfmaq_f32(acc1, b, b);
+    }
+    sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#endif
+    for (; i < n; ++i) {
+        sum += x[i] * x[i];
+    }
+    return sum;
+}
+
+// 相邻采样符号位不同的次数
+size_t zero_crossings(const float* x, size_t n) {
+    if (n < 2) {
+        return 0;
+    }
+    size_t i = 0;
+    size_t count = 0;
+#if defined(__SSE2__)
+    for (; i + 5 <= n; i += 4) {
+        __m128 a = _mm_loadu_ps(x + i);
+        __m128 b = _mm_loadu_ps(x + i + 1);
+        count += __builtin_popcount(_mm_movemask_ps(_mm_xor_ps(a, b)));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    uint32x4_t acc = vdupq_n_u32(0);
+    for (; i + 5 <= n; i += 4) {
+        uint32x4_t a = vreinterpretq_u32_f32(vld1q_f32(x + i));
+        uint32x4_t b = vreinterpretq_u32_f32(vld1q_f32(x + i + 1));
+        acc = vaddq_u32(acc, vshrq_n_u32(veorq_u32(a, b), 31));
+    }
+    count = vaddvq_u32(acc);
+#endif
+    for (; i + 1 < n; ++i) {
+        count += std::signbit(x[i]) != std::signbit(x[i + 1]);
+    }
+    return count;
+}
+
+float to_db(float mean_square) {
+    return 10.0f * std::log10(mean_square + 1e-10f);
+}
+
+} // namespace
+
+FrameFeatures compute_frame_features(const float* samples, size_t n, size_t subframe) {
+    FrameFeatures features;
+    if (n == 0) {
+        features.max_energy_db = features.min_energy_db = to_db(0.0f);
+        return features;
+    }
+    subframe = std::max<size_t>(1, std::min(subframe, n));
+    float max_ms = 0.0f;
+    float min_ms = 0.0f;
+    bool first = true;
+    for (size_t offset = 0; offset < n; offset += subframe) {
+        size_t len = std::min(subframe, n - offset);
+        // 末尾不足半个子帧的部分并入统计会让最小值偏低，只计入最大值
+        float ms = sum_squares(samples + offset, len) / len;
+        max_ms = first ? ms : std::max(max_ms, ms);
+        if (first || len * 2 >= subframe) {
+            min_ms = first ? ms : std::min(min_ms, ms);
+        }
+        first = false;
+    }
+    features.max_energy_db = to_db(max_ms);
+    features.min_energy_db = to_db(min_ms);
+    features.zcr = n > 1 ? static_cast<float>(zero_crossings(samples, n)) / (n - 1) : 0.0f;
+    return features;
+}
+
+VadGate::VadGate(int sample_rate, const VadGateOptions& options)
+    : sample_rate_(sample_rate),
+      options_(options),
+      subframe_(static_cast<size_t>(sample_rate / 100)),
+      hangover_samples_(static_cast<size_t>(options.hangover_seconds * sample_rate)),
+      warmup_samples_(static_cast<size_t>(options.warmup_seconds * sample_rate)),
+      floor_db_(options.min_floor_db),
+      skipped_(static_cast<size_t>(options.onset_seconds * sample_rate))
+{
+}
+
+void VadGate::reset() {
+    floor_db_ = options_.min_floor_db;
+    floor_valid_ = false;
+    open_remaining_ = 0;
+    skipped_.clear();
+    samples_seen_ = 0;
+    samples_skipped_ = 0;
+    samples_to_vad_ = 0;
+    openings_ = 0;
+    vad_seconds_ = 0.0;
+    gate_seconds_ = 0.0;
+}
+
+bool VadGate::triggered(const FrameFeatures& features) const {
+    float above = features.max_energy_db - floor_db_;
+    return above > options_.margin_db ||
+           (features.zcr > options_.zcr_threshold && above > options_.margin_db * 0.5f);
+}
+
+void VadGate::update_floor(const FrameFeatures& features, size_t n) {
+    float energy = std::max(features.min_energy_db, options_.min_floor_db);
+    if (!floor_valid_) {
+        floor_db_ = energy;
+        floor_valid_ = true;
+    } else if (energy < floor_db_) {
+        floor_db_ += 0.5f * (energy - floor_db_);
+    } else {
+        float rise = options_.floor_rise_db_per_second * n / sample_rate_;
+        floor_db_ = std::min(energy, floor_db_ + rise);
+    }
+}
+
+size_t VadGate::process(const float* samples, size_t n, bool vad_active, const Sink& to_vad) {
+    using Clock = std::chrono::steady_clock;
+    auto t0 = Clock::now();
+    samples_seen_ += n;
+
+    bool open = true;
+    // 门限关闭时也跟踪噪声基底，端点检测要用它判断尾部静音
+    FrameFeatures features = compute_frame_features(samples, n, subframe_);
+    if (!vad_active) {
+        // 语音期间不更新，避免把语音能量学成噪声基底
+        update_floor(features, n);
+    }
+    if (options_.enabled) {
+        bool warming_up = samples_seen_ <= warmup_samples_;
+        bool trigger = warming_up || vad_active || triggered(features);
+        if (trigger) {
+            open_remaining_ = hangover_samples_;
+        } else if (open_remaining_ > 0) {
+            open_remaining_ -= std::min(open_remaining_, n);
+        } else {
+            open = false;
+        }
+    }
+    auto t1 = Clock::now();
+    gate_seconds_ += std::chrono::duration<double>(t1 - t0).count();
+
+    if (!open) {
+        skipped_.append(samples, n);
+        samples_skipped_ += n;
+        return 0;
+    }
+
+    size_t fed = 0;
+    if (skipped_.size() > 0) {
+        // 补送门限关闭期间最近的一段音频，让 VAD 看到完整的语音起始
+        skipped_.latest(skipped_.capacity(), onset_scratch_);
+        skipped_.clear();
+        samples_skipped_ -= onset_scratch_.size();
+        ++openings_;
+        to_vad(onset_scratch_.data(), onset_scratch_.size());
+        fed += onset_scratch_.size();
+    }
+    to_vad(samples, n);
+    fed += n;
+    samples_to_vad_ += fed;
+    vad_seconds_ += std::chrono::duration<double>(Clock::now() - t1).count();
+    return fed;
+}
+
+double VadGate::saved_seconds() const {
+    if (samples_to_vad_ == 0) {
+        return 0.0;
+    }
+    return vad_seconds_ / samples_to_vad_ * samples_skipped_ - gate_seconds_;
+}
+
+void VadGate::print_stats(const std::string& name, std::ostream& os) const {
+    if (samples_seen_ == 0) {
+        return;
+    }
+    double seen_seconds = static_cast<double>(samples_seen_) / sample_rate_;
+    os << "[Gate] " << name << ": 跳过VAD推理 " << skip_ratio() * 100.0 << "% 的音频 ("
+       << static_cast<double>(samples_skipped_) / sample_rate_ << " / " << seen_seconds << " 秒)，门限重新打开 "
+       << openings_ << " 次，当前噪声基底 " << floor_db_ << " dBFS" << std::endl;
+    if (samples_to_vad_ > 0) {
+        double vad_ms_per_second = vad_seconds_ * 1000.0 / (static_cast<double>(samples_to_vad_) / sample_rate_);
+        os << "[Gate] " << name << ": VAD 每秒音频耗时 " << vad_ms_per_second << " ms，门限自身耗时 "
+           << gate_seconds_ * 1000.0 << " ms，估算节省CPU " << saved_seconds() << " 秒" << std::endl;
+    }
+}
@@ -0,0 +1,85 @@
+// vad_gate.h
+// VAD 前置的能量/过零率门限：跟踪背景噪声基底，明显低于基底的静音帧不送入 Silero VAD，
+// 省掉其 ONNX 推理。被跳过的最近一段音频保留在历史缓冲中，门限打开时先补送给 VAD，
+// 语音起始不会被截断。VAD 判定为语音期间及其后的挂起时间内门限始终打开，保证 VAD 能看到语音结束。
+// 非线程安全，只在处理线程中使用。
+#ifndef VAD_GATE_H
+#define VAD_GATE_H
+
+#include "audio_history.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct VadGateOptions {
+    bool enabled = true;
+    float margin_db = 9.0f;             // 子帧能量高于噪声基底多少 dB 即打开门限
+    float zcr_threshold = 0.25f;        // 过零率高于此值 (清辅音) 时只需一半的 margin_db
+    float floor_rise_db_per_second = 3.0f;  // 噪声基底上升速度，下降则快速跟随
+    float min_floor_db = -70.0f;        // 基底下限，避免数字静音时门限过于敏感
+    float onset_seconds = 0.4f;         // 门限打开时补送给 VAD 的被跳过音频时长
+    float hangover_seconds = 1.0f;      // 最后一次触发后保持打开的时长
+    float warmup_seconds = 0.5f;        // 启动后先全部送入 VAD，同时估计噪声基底
+};
+
+// 一帧音频的特征，由向量化实现计算
+struct FrameFeatures {
+    float max_energy_db = 0.0f;     // 10ms 子帧能量的最大值
+    float min_energy_db = 0.0f;     // 10ms 子帧能量的最小值，用于跟踪噪声基底
+    float zcr = 0.0f;               // 过零率 (每采样)
+};
+
+// 对 samples 按 subframe 个采样分段计算能量 (dBFS) 和整帧的过零率
+FrameFeatures compute_frame_features(const float* samples, size_t n, size_t subframe);
+
+class VadGate {
+public:
+    using Sink = std::function<void(const float*, size_t)>;
+
+    explicit VadGate(int sample_rate, const VadGateOptions& options = VadGateOptions());
+
+    // 处理一帧：需要送入 VAD 的音频 (可能先是补送的历史音频) 通过 to_vad 交出。
+    // vad_active 为 VAD 当前是否处于语音中或仍有未取出的语音段。返回送入 VAD 的采样数。
+    size_t process(const float* samples, size_t n, bool vad_active, const Sink& to_vad);
+
+    void reset();
+    void print_stats(const std::string& name, std::ostream& os = std::cout) const;
+
+    // 当前估计的背景噪声基底 (dBFS)
+    float noise_floor_db() const { return floor_db_; }
+    uint64_t samples_seen() const { return samples_seen_; }
+    uint64_t samples_skipped() const { return samples_skipped_; }
+    double skip_ratio() const {
+        return samples_seen_ ? static_cast<double>(samples_skipped_) / samples_seen_ : 0.0;
+    }
+    // 按实测的 VAD 每采样耗时估算因跳过而节省的 CPU 时间 (已扣除门限自身的开销)
+    double saved_seconds() const;
+
+private:
+    bool triggered(const FrameFeatures& features) const;
+    void update_floor(const FrameFeatures& features, size_t n);
+
+    int sample_rate_;
+    VadGateOptions options_;
+    size_t subframe_;
+    size_t hangover_samples_;
+    size_t warmup_samples_;
+
+    float floor_db_;
+    bool floor_valid_ = false;
+    size_t open_remaining_ = 0;
+    AudioHistory skipped_;
+    std::vector<float> onset_scratch_;
+
+    uint64_t samples_seen_ = 0;
+    uint64_t samples_skipped_ = 0;
+    uint64_t samples_to_vad_ = 0;
+    uint64_t openings_ = 0;
+    double vad_seconds_ = 0.0;
+    double gate_seconds_ = 0.0;
+};
+
+#endif // VAD_GATE_H
@@ -0,0 +1,281 @@
+// wav_file_source.cpp
+// mmap WAV 文件输入源：支持按实时节奏回放或尽可能快地回放
+
+#include "wav_file_source.h"
+#include <algorithm>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+uint16_t read_u16(const uint8_t* p) {
+    uint16_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t read_u32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+} // namespace
+
+MappedWav::MappedWav(const std::string& path) : path_(path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("无法打开WAV文件: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 44) {
+        ::close(fd);
+        throw std::runtime_error("WAV文件过小或无法读取: " + path);
+    }
+    mapping_size_ = static_cast<size_t>(st.st_size);
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        throw std::runtime_error("mmap WAV文件失败: " + path);
+    }
+    madvise(mapping_, mapping_size_, MADV_SEQUENTIAL);
+
+    const uint8_t* base = static_cast<const uint8_t*>(mapping_);
+    if (std::memcmp(base, "RIFF", 4) != 0 || std::memcmp(base + 8, "WAVE", 4) != 0) {
+        munmap(mapping_, mapping_size_);
+        throw std::runtime_error("不是有效的WAV文件: " + path);
+    }
+
+    bool have_fmt = false;
+    int channels = 0;
+    int bits = 0;
+    uint16_t audio_format = 0;
+    size_t data_size = 0;
+    size_t pos = 12;
+    while (pos + 8 <= mapping_size_) {
+        const uint8_t* chunk = base + pos;
+        size_t chunk_size = read_u32(chunk + 4);
+        const uint8_t* body = chunk + 8;
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16) {
+            audio_format = read_u16(body);
+            channels = read_u16(body + 2);
+            sample_rate_ = static_cast<int>(read_u32(body + 4));
+            bits = read_u16(body + 14);
+            // WAVE_FORMAT_EXTENSIBLE：实际格式在子格式 GUID 的前两个字节
+            if (audio_format == 0xFFFE && chunk_size >= 26) {
+                audio_format = read_u16(body + 24);
+            }
+            have_fmt = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            data_ = body;
+            data_size = std::min(chunk_size, mapping_size_ - (pos + 8));
+            break;
+        }
+        pos += 8 + chunk_size + (chunk_size & 1);
+    }
+
+    std::string error;
+    if (!have_fmt || !data_) {
+        error = "WAV文件缺少 fmt 或 data 块: ";
+    } else if (channels != 1) {
+        error = "仅支持单声道WAV文件: ";
+    } else if (audio_format == 1 && bits == 16) {
+        format_ = Format::Pcm16;
+        num_samples_ = data_size / sizeof(int16_t);
+    } else if (audio_format == 3 && bits == 32) {
+        format_ = Format::Float32;
+        num_samples_ = data_size / sizeof(float);
+    } else {
+        error = "仅支持16-bit PCM或32-bit float WAV文件: ";
+    }
+    if (!error.empty()) {
+        munmap(mapping_, mapping_size_);
+        throw std::runtime_error(error + path);
+    }
+}
+
+MappedWav::~MappedWav() {
+    if (mapping_) {
+        munmap(mapping_, mapping_size_);
+    }
+}
+
+const int16_t* MappedWav::pcm16() const {
+    return format_ == Format::Pcm16 ? reinterpret_cast<const int16_t*>(data_) : nullptr;
+}
+
+const float* MappedWav::pcm_f32() const {
+    return format_ == Format::Float32 ? reinterpret_cast<const float*>(data_) : nullptr;
+}
+
+void MappedWav::to_float(size_t offset, size_t n, float* out) const {
+    if (format_ == Format::Float32) {
+        std::memcpy(out, pcm_f32() + offset, n * sizeof(float));
+        return;
+    }
+    const int16_t* in = pcm16() + offset;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = in[i] / 32768.0f;
+    }
+}
+
+WavFileSource::WavFileSource(std::vector<std::string> paths, Pacing pacing, bool loop,
+                             float gap_seconds)
+    : paths_(std::move(paths)),
+      pacing_(pacing),
+      loop_(loop),
+      gap_seconds_(gap_seconds)
+{
+}
+
+WavFileSource::~WavFileSource() {
+    stop();
+}
+
+std::vector<std::string> WavFileSource::expand_paths(const std::vector<std::string>& paths) {
+    std::vector<std::string> result;
+    for (const auto& path : paths) {
+        DIR* dir = opendir(path.c_str());
+        if (!dir) {
+            result.push_back(path);
+            continue;
+        }
+        std::vector<std::string> entries;
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(name.size() - 4, 4, ".wav") == 0) {
+                entries.push_back(path + "/" + name);
+            }
+        }
+        closedir(dir);
+        std::sort(entries.begin(), entries.end());
+        result.insert(result.end(), entries.begin(), entries.end());
+    }
+    return result;
+}
+
+bool WavFileSource::start() {
+    files_.clear();
+    for (const auto& path : expand_paths(paths_)) {
+        try {
+            auto wav = std::make_unique<MappedWav>(path);
+            if (wav->num_samples() == 0) {
+                // 空文件不产生任何采样，全部为空且无间隔静音时循环回放会空转
+                std::cerr << "警告：WAV文件没有音频数据，已跳过: " << path << std::endl;
+                continue;
+            }
+            if (!files_.empty() && wav->sample_rate() != sample_rate_) {
+                std::cerr << "错误：WAV文件采样率不一致: " << path << std::endl;
+                return false;
+            }
+            sample_rate_ = wav->sample_rate();
+            files_.push_back(std::move(wav));
+        } catch (const std::exception& e) {
+            std::cerr << "错误：" << e.what() << std::endl;
+            return false;
+        }
+    }
+    if (files_.empty()) {
+        std::cerr << "错误：没有可回放的WAV文件" << std::endl;
+        return false;
+    }
+
+    file_index_ = 0;
+    offset_ = 0;
+    in_gap_ = false;
+    samples_delivered_ = 0;
+    loops_completed_ = 0;
+    start_time_ = std::chrono::steady_clock::now();
+
+    std::cout << "\n音频源: " << files_.size() << " 个WAV文件 ("
+              << (pacing_ == Pacing::Realtime ? "实时节奏" : "尽可能快") << "回放"
+              << (loop_ ? "，循环" : "") << ")" << std::endl;
+    return true;
+}
+
+void WavFileSource::stop() {
+    // 释放映射前记下名称，停止后打印的运行摘要仍能显示文件名
+    if (!files_.empty()) {
+        last_name_ = name();
+    }
+    files_.clear();
+}
+
+ReadStatus WavFileSource::read(AudioFrame& frame, size_t max_samples, int /*timeout_ms*/) {
+    if (files_.empty()) {
+        return ReadStatus::Error;
+    }
+
+    // 当前文件 (或其后的静音) 读完后切换到下一个文件
+    while (true) {
+        const MappedWav& wav = *files_[file_index_];
+        if (!in_gap_ && offset_ >= wav.num_samples()) {
+            in_gap_ = true;
+            gap_remaining_ = static_cast<size_t>(gap_seconds_ * sample_rate_);
+        }
+        if (!in_gap_ || gap_remaining_ > 0) {
+            break;
+        }
+        in_gap_ = false;
+        offset_ = 0;
+        if (++file_index_ == files_.size()) {
+            file_index_ = 0;
+            ++loops_completed_;
+            if (!loop_) {
+                return ReadStatus::Finished;
+            }
+        }
+    }
+
+    const MappedWav& wav = *files_[file_index_];
+    if (in_gap_) {
+        if (silence_.size() < max_samples) {
+            silence_.assign(max_samples, 0.0f);
+        }
+        frame.data = silence_.data();
+        frame.size = std::min(max_samples, gap_remaining_);
+        gap_remaining_ -= frame.size;
+    } else {
+        frame.size = std::min(max_samples, wav.num_samples() - offset_);
+        if (wav.format() == MappedWav::Format::Float32) {
+            // float 文件直接返回映射内存，零拷贝
+            frame.data = wav.pcm_f32() + offset_;
+        } else {
+            if (scratch_.size() < max_samples) {
+                scratch_.resize(max_samples);
+            }
+            wav.to_float(offset_, frame.size, scratch_.data());
+            frame.data = scratch_.data();
+        }
+        offset_ += frame.size;
+    }
+
+    samples_delivered_ += frame.size;
+    if (pacing_ == Pacing::Realtime) {
+        // 这一帧的最后一个采样“到达”之后才交付，与麦克风的行为一致
+        auto due = start_time_ + std::chrono::microseconds(samples_delivered_ * 1000000 / sample_rate_);
+        std::this_thread::sleep_until(due);
+    }
+    return ReadStatus::Ok;
+}
+
+std::string WavFileSource::name() const {
+    if (files_.empty()) {
+        return last_name_.empty() ? "WAV回放" : last_name_;
+    }
+    return "WAV回放: " + files_[file_index_]->path();
+}
+
+void WavFileSource::print_stats() const {
+    double audio_seconds = static_cast<double>(samples_delivered_) / sample_rate_;
+    std::cout << "[Source] 已回放 " << audio_seconds << " 秒音频，完成 "
+              << loops_completed_ << " 轮" << std::endl;
+}
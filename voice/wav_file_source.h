@@ -0,0 +1,95 @@
+// wav_file_source.h
+// 基于 mmap 的 WAV 文件输入源，用于无麦克风环境下的回放、基准测试和长时间浸泡测试
+#ifndef WAV_FILE_SOURCE_H
+#define WAV_FILE_SOURCE_H
+
+#include "audio_source.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 只读映射的单声道 WAV 文件 (16-bit PCM 或 32-bit float)。
+// 采样数据直接指向映射内存，不做拷贝。
+class MappedWav {
+public:
+    enum class Format {
+        Pcm16,
+        Float32
+    };
+
+    explicit MappedWav(const std::string& path);
+    ~MappedWav();
+    MappedWav(const MappedWav&) = delete;
+    MappedWav& operator=(const MappedWav&) = delete;
+
+    const std::string& path() const { return path_; }
+    Format format() const { return format_; }
+    int sample_rate() const { return sample_rate_; }
+    size_t num_samples() const { return num_samples_; }
+
+    // 按格式取用，格式不符时返回 nullptr
+    const int16_t* pcm16() const;
+    const float* pcm_f32() const;
+
+    // 将 [offset, offset + n) 转为 float 写入 out；Float32 文件可直接使用 pcm_f32()
+    void to_float(size_t offset, size_t n, float* out) const;
+
+private:
+    std::string path_;
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    const uint8_t* data_ = nullptr;
+    Format format_ = Format::Pcm16;
+    int sample_rate_ = 0;
+    size_t num_samples_ = 0;
+};
+
+class WavFileSource : public AudioSource {
+public:
+    enum class Pacing {
+        Realtime,      // 按音频时长节奏回放，模拟真实麦克风
+        AsFastAsPossible
+    };
+
+    // 每个文件之后追加 gap_seconds 的静音，让 VAD 能正常结束每句话
+    WavFileSource(std::vector<std::string> paths, Pacing pacing, bool loop = false,
+                  float gap_seconds = 1.0f);
+    ~WavFileSource() override;
+
+    bool start() override;
+    void stop() override;
+    ReadStatus read(AudioFrame& frame, size_t max_samples, int timeout_ms) override;
+
+    int sample_rate() const override { return sample_rate_; }
+    std::string name() const override;
+    bool is_realtime() const override { return pacing_ == Pacing::Realtime; }
+    void print_stats() const override;
+
+    // 展开目录中的 *.wav (按文件名排序)，普通文件原样保留
+    static std::vector<std::string> expand_paths(const std::vector<std::string>& paths);
+
+private:
+    std::vector<std::string> paths_;
+    Pacing pacing_;
+    bool loop_;
+    float gap_seconds_;
+    int sample_rate_ = 16000;
+
+    std::vector<std::unique_ptr<MappedWav>> files_;
+    std::string last_name_;     // stop() 释放文件前的 name()
+    size_t file_index_ = 0;
+    size_t offset_ = 0;         // 当前文件内的采样偏移
+    size_t gap_remaining_ = 0;  // 当前文件之后还需输出的静音采样数
+    bool in_gap_ = false;
+
+    std::vector<float> scratch_;   // 16-bit 文件转换用的预分配缓冲区
+    std::vector<float> silence_;
+
+    std::chrono::steady_clock::time_point start_time_;
+    uint64_t samples_delivered_ = 0;
+    uint64_t loops_completed_ = 0;
+};
+
+#endif // WAV_FILE_SOURCE_H
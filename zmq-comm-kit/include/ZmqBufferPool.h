@@ -0,0 +1,64 @@
+#pragma once
+#include <zmq.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace zmq_component {
+
+class ZmqBufferPool;
+
+// 从 ZmqBufferPool 取得的发送缓冲区 (只可移动)。
+// 交给 makeMessage()/send 之后所有权转移给 ZMQ，发送完成时自动归还到池中。
+class PooledBuffer {
+public:
+    PooledBuffer() = default;
+    ~PooledBuffer();
+    PooledBuffer(PooledBuffer&& other) noexcept;
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept;
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    void* data();
+    const void* data() const;
+    size_t size() const { return size_; }
+    size_t capacity() const;
+    // 调整有效数据长度，不能超过 capacity()
+    void resize(size_t size);
+    explicit operator bool() const { return block_ != nullptr; }
+
+    struct Block;  // 实现细节，定义在 ZmqBufferPool.cpp 中
+
+private:
+    friend class ZmqBufferPool;
+    friend zmq::message_t makeMessage(PooledBuffer&& buffer);
+    PooledBuffer(Block* block, size_t size) : block_(block), size_(size) {}
+    Block* release();
+
+    Block* block_ = nullptr;
+    size_t size_ = 0;
+};
+
+// 发送缓冲区池：按固定块大小缓存空闲内存块，避免每条消息都 malloc/free。
+// 超过块大小的请求单独分配，同样可以零拷贝发送。线程安全。
+class ZmqBufferPool {
+public:
+    explicit ZmqBufferPool(size_t block_size = 64 * 1024, size_t max_cached_blocks = 64);
+    ~ZmqBufferPool();
+    ZmqBufferPool(const ZmqBufferPool&) = delete;
+    ZmqBufferPool& operator=(const ZmqBufferPool&) = delete;
+
+    PooledBuffer acquire(size_t size);
+
+    size_t blockSize() const;
+    size_t cachedBlocks() const;
+    uint64_t allocations() const;  // 实际向系统申请内存的次数
+    uint64_t reuses() const;       // 从池中复用的次数
+
+    struct State;
+
+private:
+    std::shared_ptr<State> state_;
+};
+
+} // namespace zmq_component
@@ -1,14 +1,29 @@
 #pragma once
 #include "ZmqInterface.h"
+#include "ZmqMessage.h"
+#include <string_view>
 
 namespace zmq_component {
 
 class ZmqClient : public ZmqInterface {
 public:
-    explicit ZmqClient(const std::string& address = "tcp://localhost:6666");
-    void sendRequest(const std::string& message);
+    explicit ZmqClient(const std::string& address = "tcp://localhost:6666",
+                       std::shared_ptr<zmq::context_t> context = nullptr);
+    void sendRequest(std::string_view message);
+    void sendRequest(const char* message);
+    // 零拷贝发送：接管缓冲区所有权，ZMQ 发送完成后释放/归还到池中
+    void sendRequest(std::string&& message);
+    void sendRequest(PooledBuffer&& buffer);
+    void sendRequest(zmq::message_t&& message);
+
+    // 超时抛出 ZmqCommunicationError，并重建套接字以便下次请求可用。
+    // 需要自动重试时使用 ZmqReliableClient
     std::string receiveResponse();
+    // 零拷贝接收：直接返回 ZMQ 持有的消息，可用 to_string_view() 读取
+    zmq::message_t receiveResponseMessage();
+
     std::string request(const std::string& message);
+    zmq::message_t request(zmq::message_t&& message);
 };
 
-} // namespace zmq_component
\ No newline at end of file
+} // namespace zmq_component
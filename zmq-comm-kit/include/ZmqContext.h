@@ -0,0 +1,29 @@
+#pragma once
+#include <zmq.hpp>
+#include <memory>
+#include <mutex>
+
+namespace zmq_component {
+
+// 进程级共享的 ZMQ 上下文 (引用计数)。
+// 同一进程内的 Client/Server/Subscriber/Publisher 默认共用这一个上下文，
+// 只启动一组 I/O 线程，并且可以通过 inproc:// 互相通信。
+// 最后一个持有者释放后上下文被销毁，下一次 acquire() 会重新创建。
+class ZmqContext {
+public:
+    // 设置 I/O 线程数。只对之后新建的上下文生效，应在创建任何套接字之前调用。
+    static void setIoThreads(int io_threads);
+    static int ioThreads();
+
+    static std::shared_ptr<zmq::context_t> acquire();
+
+    // 当前共享上下文的持有者数量，0 表示尚未创建或已销毁
+    static long useCount();
+
+private:
+    static std::mutex mutex_;
+    static std::weak_ptr<zmq::context_t> instance_;
+    static int io_threads_;
+};
+
+} // namespace zmq_component
@@ -1,5 +1,6 @@
 #pragma once
 #include <zmq.hpp>
+#include <atomic>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -13,15 +14,51 @@ public:
 
 class ZmqInterface {
 protected:
-    std::unique_ptr<zmq::context_t> context_;
+    std::shared_ptr<zmq::context_t> context_;
     std::unique_ptr<zmq::socket_t> socket_;
     int timeout_ms_ = -1;
+    std::atomic<bool> interrupted_{false};
 
+    // 记录套接字参数，便于 resetSocket() 重建
+    int socket_type_ = -1;
+    std::string address_;
+    bool bind_ = false;
+
+    // context 为空时使用进程级共享上下文 (见 ZmqContext)
+    explicit ZmqInterface(std::shared_ptr<zmq::context_t> context = nullptr);
+
+    // REP/PUB/ROUTER 默认 bind，其余类型默认 connect
     void setupSocket(int socket_type, const std::string& address);
+    void setupSocket(int socket_type, const std::string& address, bool bind);
+
+    // 丢弃当前套接字 (linger=0，未发出的消息一并丢弃) 并按原参数重建。
+    // 用于超时后 REQ 等有状态套接字已处于错误状态的情况
+    void resetSocket();
+
+    // 发送/接收一帧，超时抛出 ZmqCommunicationError
+    void sendFrame(zmq::message_t& message, zmq::send_flags flags = zmq::send_flags::none);
+    zmq::message_t receiveFrame();
+
+    // 等待套接字可读 (timeout_ms < 0 表示一直等待)，期间每 100ms 检查一次 interrupt()。
+    // 超时或被中断时返回 false
+    bool waitReadable(int timeout_ms);
     
 public:
     virtual ~ZmqInterface();
     void setTimeout(int milliseconds);
+
+    // 线程安全：让另一个线程中正在等待回复的请求尽快以 ZmqCommunicationError 结束，
+    // 之后的请求也立即失败。用于退出时不必等到请求超时
+    void interrupt() { interrupted_ = true; }
+    bool interrupted() const { return interrupted_; }
+
+    // 在同一个套接字上追加监听/连接其他地址 (例如同时连接 tcp:// 与 inproc://)
+    void bind(const std::string& address);
+    void connect(const std::string& address);
+
+    const std::shared_ptr<zmq::context_t>& context() const { return context_; }
+    // 底层套接字，供 zmq::poll 等事件循环等待可读/可写
+    zmq::socket_t& socket() { return *socket_; }
 };
 
-} // namespace zmq_component
\ No newline at end of file
+} // namespace zmq_component
@@ -0,0 +1,23 @@
+#pragma once
+#include "ZmqBufferPool.h"
+#include <zmq.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace zmq_component {
+
+// 构造待发送的 zmq::message_t。
+// 右值版本接管调用方缓冲区的所有权，ZMQ 发送完成后通过释放回调回收，负载零拷贝；
+// 视图版本无法确定调用方缓冲区的生命周期，会拷贝一次。
+
+zmq::message_t makeMessage(std::string&& data);
+zmq::message_t makeMessage(std::vector<char>&& data);
+zmq::message_t makeMessage(std::vector<float>&& data);
+zmq::message_t makeMessage(std::vector<int16_t>&& data);
+zmq::message_t makeMessage(PooledBuffer&& buffer);
+zmq::message_t makeMessage(std::string_view data);
+zmq::message_t makeMessage(const char* data);
+
+} // namespace zmq_component
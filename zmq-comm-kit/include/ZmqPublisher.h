@@ -0,0 +1,16 @@
+#pragma once
+#include "ZmqInterface.h"
+
+namespace zmq_component {
+
+class ZmqPublisher : public ZmqInterface {
+public:
+    explicit ZmqPublisher(const std::string& address = "tcp://*:6677",
+                          std::shared_ptr<zmq::context_t> context = nullptr);
+    // 发送单帧消息，订阅方按消息前缀过滤 (例如 "STATUS::SPEAKING")
+    void publish(const std::string& message);
+    // 发送 [topic][payload] 两帧消息
+    void publish(const std::string& topic, const std::string& payload);
+};
+
+} // namespace zmq_component
@@ -0,0 +1,22 @@
+#pragma once
+#include "ZmqInterface.h"
+#include <vector>
+
+namespace zmq_component {
+
+// PULL 端：默认 bind，从所有已连接的 PUSH 端公平地接收消息
+class ZmqPuller : public ZmqInterface {
+public:
+    explicit ZmqPuller(const std::string& address = "tcp://*:6680",
+                       std::shared_ptr<zmq::context_t> context = nullptr);
+
+    // 阻塞接收 (受 setTimeout 约束)，超时抛出 ZmqCommunicationError
+    std::string receive();
+    zmq::message_t receiveMessage();
+    // 接收一条完整的多帧消息 (覆盖 parts 原内容)，超时抛出 ZmqCommunicationError
+    void receiveMultipart(std::vector<zmq::message_t>& parts);
+    // 非阻塞接收一条多帧消息，没有消息时返回 false
+    bool tryReceiveMultipart(std::vector<zmq::message_t>& parts);
+};
+
+} // namespace zmq_component
@@ -0,0 +1,20 @@
+#pragma once
+#include "ZmqInterface.h"
+#include "ZmqMessage.h"
+#include <string_view>
+#include <vector>
+
+namespace zmq_component {
+
+// PUSH 端：单向发送，多个 PULL 端时按轮询分发。默认 connect，适合大量边缘设备连到同一个接收端
+class ZmqPusher : public ZmqInterface {
+public:
+    explicit ZmqPusher(const std::string& address = "tcp://localhost:6680",
+                       std::shared_ptr<zmq::context_t> context = nullptr);
+    void push(std::string_view message);
+    void push(zmq::message_t&& message);
+    // 按顺序发送多帧消息，接收端一次收到全部帧
+    void pushMultipart(std::vector<zmq::message_t>& parts);
+};
+
+} // namespace zmq_component
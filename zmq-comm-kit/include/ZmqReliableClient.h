@@ -0,0 +1,60 @@
+#pragma once
+#include "ZmqInterface.h"
+#include "ZmqMessage.h"
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+namespace zmq_component {
+
+struct RetryPolicy {
+    int timeout_ms = 2500;          // 每次尝试等待回复的时间
+    int max_retries = 3;            // 首次发送之外的最大重试次数
+    int backoff_initial_ms = 10;    // 第一次重试前的等待，之后每次翻倍
+    int backoff_max_ms = 1000;
+};
+
+struct ReliableClientStats {
+    uint64_t requests = 0;
+    uint64_t successes = 0;
+    uint64_t failures = 0;
+    uint64_t retries = 0;
+    uint64_t reconnects = 0;
+    uint64_t late_replies_dropped = 0;
+    double last_latency_ms = 0.0;
+    double total_latency_ms = 0.0;
+    double max_latency_ms = 0.0;
+
+    double averageLatencyMs() const { return successes ? total_latency_ms / successes : 0.0; }
+};
+
+// 可靠请求客户端 ("lazy pirate" 模式)。
+// 与普通 REQ 客户端不同，超时后不会卡死：丢弃并重建套接字，按退避策略重发。
+// 底层使用 DEALER 套接字，每个请求带 [请求ID][空帧] 信封，REP 服务端会原样带回，
+// 因此服务端无需修改；ID 不匹配的迟到回复会被丢弃并计数。
+// 重发时服务端会再处理一次同一请求 (它看不到请求ID)，只有幂等的请求才应开启重试，否则把 max_retries 设为 0。
+class ZmqReliableClient : public ZmqInterface {
+public:
+    explicit ZmqReliableClient(const std::string& address = "tcp://localhost:6666",
+                               const RetryPolicy& policy = RetryPolicy(),
+                               std::shared_ptr<zmq::context_t> context = nullptr);
+
+    // 所有重试都失败时抛出 ZmqCommunicationError
+    std::string request(std::string_view message);
+    zmq::message_t request(zmq::message_t&& message);
+
+    void setRetryPolicy(const RetryPolicy& policy);
+    const RetryPolicy& retryPolicy() const { return policy_; }
+    const ReliableClientStats& stats() const { return stats_; }
+
+private:
+    bool sendAttempt(uint64_t request_id, zmq::message_t& payload);
+    bool awaitReply(uint64_t request_id, std::chrono::steady_clock::time_point deadline,
+                    zmq::message_t& reply);
+
+    RetryPolicy policy_;
+    ReliableClientStats stats_;
+    uint64_t next_request_id_ = 0;
+};
+
+} // namespace zmq_component
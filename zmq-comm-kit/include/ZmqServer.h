@@ -1,5 +1,7 @@
 #pragma once
 #include "ZmqInterface.h"
+#include "ZmqMessage.h"
+#include <string_view>
 
 namespace zmq_component
 {
@@ -7,9 +9,18 @@ namespace zmq_component
     class ZmqServer : public ZmqInterface
     {
     public:
-        explicit ZmqServer(const std::string &address = "tcp://*:6666");
+        explicit ZmqServer(const std::string &address = "tcp://*:6666",
+                           std::shared_ptr<zmq::context_t> context = nullptr);
         std::string receive();
-        void send(const std::string &response);
+        // 零拷贝接收：直接返回 ZMQ 持有的消息，可用 to_string_view() 读取
+        zmq::message_t receiveMessage();
+
+        void send(std::string_view response);
+        void send(const char *response);
+        // 零拷贝发送：接管缓冲区所有权，ZMQ 发送完成后释放/归还到池中
+        void send(std::string &&response);
+        void send(PooledBuffer &&buffer);
+        void send(zmq::message_t &&response);
     };
 
-} // namespace zmq_component
\ No newline at end of file
+} // namespace zmq_component
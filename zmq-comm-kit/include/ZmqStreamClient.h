@@ -0,0 +1,97 @@
+#pragma once
+#include "ZmqInterface.h"
+#include "ZmqMessage.h"
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string_view>
+
+namespace zmq_component {
+
+// 流式响应协议 (ZmqStreamClient / ZmqStreamServer 共用)：
+//   请求: [请求ID][空帧][负载]
+//   响应: [请求ID][空帧][标志][数据块]，每个数据块一条消息，标志为 kStreamMore 或 kStreamEnd
+// 普通 REP 服务端的单帧回复 [请求ID][空帧][负载] 视为只有一个数据块的完整响应。
+constexpr char kStreamMore = 'M';
+constexpr char kStreamEnd = 'E';
+
+class ZmqStreamClient;
+
+// 一次流式请求的响应，按到达顺序逐块读取。
+// 同一客户端上发起新请求后，旧响应中尚未读取的数据块会被丢弃。
+class ZmqResponseStream {
+public:
+    // 读取下一块，响应已结束时返回 false；超时抛出 ZmqCommunicationError
+    bool next(zmq::message_t& chunk);
+    bool finished() const { return finished_; }
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = zmq::message_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = zmq::message_t*;
+        using reference = zmq::message_t&;
+
+        iterator() = default;
+        explicit iterator(ZmqResponseStream* stream) : stream_(stream) { ++*this; }
+
+        reference operator*() { return chunk_; }
+        pointer operator->() { return &chunk_; }
+        iterator& operator++() {
+            if (stream_ && !stream_->next(chunk_)) {
+                stream_ = nullptr;
+            }
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return stream_ == other.stream_; }
+        bool operator!=(const iterator& other) const { return stream_ != other.stream_; }
+
+    private:
+        ZmqResponseStream* stream_ = nullptr;
+        zmq::message_t chunk_;
+    };
+
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+private:
+    friend class ZmqStreamClient;
+    ZmqResponseStream(ZmqStreamClient& client, uint64_t request_id)
+        : client_(&client), request_id_(request_id) {}
+
+    ZmqStreamClient* client_;
+    uint64_t request_id_;
+    bool finished_ = false;
+};
+
+// 流式请求客户端 (DEALER)：响应以多个数据块陆续到达，调用方可以边收边处理，
+// 例如第一句话到达后立即交给 TTS，而不必等待整段回答生成完毕。
+// setTimeout() 设置的是相邻两个数据块之间的最长等待时间；interrupt() 可让等待中的请求提前结束。
+class ZmqStreamClient : public ZmqInterface {
+public:
+    // 回调返回 false 时停止接收，剩余数据块被丢弃
+    using ChunkHandler = std::function<bool(std::string_view chunk)>;
+
+    explicit ZmqStreamClient(const std::string& address = "tcp://localhost:6666",
+                             std::shared_ptr<zmq::context_t> context = nullptr);
+
+    // 迭代器方式：for (auto& chunk : client.stream("...")) { ... }
+    ZmqResponseStream stream(std::string_view message);
+    ZmqResponseStream stream(zmq::message_t&& message);
+
+    // 回调方式：阻塞直到响应结束或回调返回 false，返回收到的数据块数
+    size_t request(std::string_view message, const ChunkHandler& on_chunk);
+
+    uint64_t staleChunksDropped() const { return stale_chunks_dropped_; }
+
+private:
+    friend class ZmqResponseStream;
+    // 读取属于 request_id 的下一块，返回是否为最后一块
+    bool receiveChunk(uint64_t request_id, zmq::message_t& chunk);
+
+    uint64_t next_request_id_ = 0;
+    uint64_t stale_chunks_dropped_ = 0;
+};
+
+} // namespace zmq_component
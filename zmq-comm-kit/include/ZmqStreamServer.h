@@ -0,0 +1,52 @@
+#pragma once
+#include "ZmqInterface.h"
+#include "ZmqMessage.h"
+#include "ZmqStreamClient.h"
+#include <string_view>
+#include <vector>
+
+namespace zmq_component
+{
+
+    // 一条待回复的流式请求：保存客户端路由信封，可陆续发送多个数据块
+    class ZmqStreamRequest
+    {
+    public:
+        const zmq::message_t &payload() const { return payload_; }
+        std::string_view text() const { return payload_.to_string_view(); }
+        bool finished() const { return finished_; }
+
+    private:
+        friend class ZmqStreamServer;
+        std::vector<zmq::message_t> envelope_;  // [客户端ID][请求ID][空帧]
+        zmq::message_t payload_;
+        bool finished_ = false;
+    };
+
+    // 流式响应服务端 (ROUTER)：每个请求可回复任意多个数据块，最后以结束标志收尾。
+    // 协议见 ZmqStreamClient.h。多个客户端的请求可以交错处理。
+    class ZmqStreamServer : public ZmqInterface
+    {
+    public:
+        explicit ZmqStreamServer(const std::string &address = "tcp://*:6666",
+                                 std::shared_ptr<zmq::context_t> context = nullptr);
+
+        // 阻塞等待下一条请求，超时抛出 ZmqCommunicationError
+        ZmqStreamRequest receive();
+
+        // 发送一个中间数据块
+        void sendChunk(ZmqStreamRequest &request, std::string_view chunk);
+        void sendChunk(ZmqStreamRequest &request, const char *chunk);
+        void sendChunk(ZmqStreamRequest &request, std::string &&chunk);
+        void sendChunk(ZmqStreamRequest &request, zmq::message_t &&chunk);
+
+        // 发送最后一块 (可为空) 并结束该请求的响应
+        void finish(ZmqStreamRequest &request, std::string_view last_chunk = {});
+        void finish(ZmqStreamRequest &request, const char *last_chunk);
+        void finish(ZmqStreamRequest &request, zmq::message_t &&last_chunk);
+
+    private:
+        void sendFrames(ZmqStreamRequest &request, char flag, zmq::message_t &chunk);
+    };
+
+} // namespace zmq_component
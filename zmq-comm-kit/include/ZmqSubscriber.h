@@ -0,0 +1,23 @@
+#pragma once
+#include "ZmqInterface.h"
+
+namespace zmq_component {
+
+class ZmqSubscriber : public ZmqInterface {
+public:
+    // topic 为空字符串时订阅全部消息
+    explicit ZmqSubscriber(const std::string& address = "tcp://localhost:6677",
+                           const std::string& topic = "",
+                           std::shared_ptr<zmq::context_t> context = nullptr);
+    void subscribe(const std::string& topic);
+    void unsubscribe(const std::string& topic);
+
+    // 阻塞接收 (受 setTimeout 约束)，超时抛出 ZmqCommunicationError
+    std::string receive();
+    // 非阻塞接收，没有消息时返回 false
+    bool tryReceive(std::string& message);
+    // 非阻塞接收一条两帧消息 [主题][载荷] (对应 ZmqPublisher::publish(topic, payload))，没有消息时返回 false
+    bool tryReceive(std::string& topic, std::string& payload);
+};
+
+} // namespace zmq_component
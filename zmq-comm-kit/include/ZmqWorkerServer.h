@@ -0,0 +1,73 @@
+#pragma once
+#include "ZmqInterface.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace zmq_component
+{
+
+    // 多工作线程服务端：ROUTER 前端接收客户端请求，经 inproc ROUTER 后端按“空闲者优先”分发给 N 个工作线程。
+    // 工作线程处理完一个请求才领取下一个，请求在中转线程中排队，只交给空闲的工作线程；
+    // 慢请求只占用一个工作线程，后续请求不会排在它后面。回复按完成顺序返回 (可能与请求顺序不同)。
+    // 兼容 REQ 客户端与 ZmqReliableClient：请求信封原样带回。
+    class ZmqWorkerServer : public ZmqInterface
+    {
+    public:
+        // 在工作线程中调用，返回回复内容；抛出任何异常时回复空消息并计入 errors
+        using Handler = std::function<zmq::message_t(zmq::message_t &request)>;
+
+        struct WorkerStats
+        {
+            uint64_t handled = 0;
+            uint64_t errors = 0;
+            double busy_ms = 0.0;        // 处理函数累计耗时
+        };
+
+        // num_workers 为 0 时使用硬件线程数
+        ZmqWorkerServer(const std::string &address, Handler handler, size_t num_workers = 0,
+                        std::shared_ptr<zmq::context_t> context = nullptr);
+        ~ZmqWorkerServer() override;
+
+        ZmqWorkerServer(const ZmqWorkerServer &) = delete;
+        ZmqWorkerServer &operator=(const ZmqWorkerServer &) = delete;
+
+        void start();
+        // 停止转发并等待所有工作线程处理完当前请求后退出，未处理的请求被丢弃
+        void stop();
+        bool running() const { return running_; }
+
+        size_t numWorkers() const { return workers_.size(); }
+        std::vector<WorkerStats> workerStats() const;
+        // 已收到、正在等待空闲工作线程的请求数
+        size_t queueDepth() const { return queue_depth_; }
+        size_t maxQueueDepth() const { return max_queue_depth_; }
+
+    private:
+        struct Worker
+        {
+            std::thread thread;
+            std::atomic<uint64_t> handled{0};
+            std::atomic<uint64_t> errors{0};
+            std::atomic<uint64_t> busy_us{0};
+        };
+
+        void runBroker();
+        void runWorker(Worker &worker);
+
+        Handler handler_;
+        std::string backend_address_;
+        std::string control_address_;
+        std::unique_ptr<zmq::socket_t> backend_;
+        std::unique_ptr<zmq::socket_t> control_;
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::thread broker_;
+        std::atomic<bool> running_{false};
+        std::atomic<bool> stopping_{false};
+        std::atomic<size_t> queue_depth_{0};
+        std::atomic<size_t> max_queue_depth_{0};
+    };
+
+} // namespace zmq_component
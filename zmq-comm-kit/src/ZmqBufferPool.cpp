@@ -0,0 +1,156 @@
+#include "ZmqBufferPool.h"
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+namespace zmq_component {
+
+struct ZmqBufferPool::State {
+    std::mutex mutex;
+    std::vector<PooledBuffer::Block*> free_blocks;
+    size_t block_size;
+    size_t max_cached_blocks;
+    bool closed = false;
+    uint64_t allocations = 0;
+    uint64_t reuses = 0;
+};
+
+// 块头部后紧跟数据区；owner 让池对象销毁后仍在途的块可以安全归还
+struct PooledBuffer::Block {
+    std::shared_ptr<ZmqBufferPool::State> owner;
+    size_t capacity;
+
+    unsigned char* payload() { return reinterpret_cast<unsigned char*>(this + 1); }
+
+    static Block* create(std::shared_ptr<ZmqBufferPool::State> owner, size_t capacity) {
+        void* memory = ::operator new(sizeof(Block) + capacity);
+        return new (memory) Block{std::move(owner), capacity};
+    }
+
+    static void destroy(Block* block) {
+        block->~Block();
+        ::operator delete(block);
+    }
+
+    // 归还到池中；池已关闭、块大小不符或缓存已满时直接释放
+    static void recycle(Block* block) {
+        auto owner = block->owner;
+        {
+            std::lock_guard<std::mutex> lock(owner->mutex);
+            if (!owner->closed && block->capacity == owner->block_size &&
+                owner->free_blocks.size() < owner->max_cached_blocks) {
+                owner->free_blocks.push_back(block);
+                return;
+            }
+        }
+        destroy(block);
+    }
+};
+
+PooledBuffer::~PooledBuffer() {
+    if (block_) Block::recycle(block_);
+}
+
+PooledBuffer::PooledBuffer(PooledBuffer&& other) noexcept
+    : block_(other.block_), size_(other.size_) {
+    other.block_ = nullptr;
+    other.size_ = 0;
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) noexcept {
+    if (this != &other) {
+        if (block_) Block::recycle(block_);
+        block_ = other.block_;
+        size_ = other.size_;
+        other.block_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void* PooledBuffer::data() { return block_ ? block_->payload() : nullptr; }
+const void* PooledBuffer::data() const { return block_ ? block_->payload() : nullptr; }
+size_t PooledBuffer::capacity() const { return block_ ? block_->capacity : 0; }
+
+void PooledBuffer::resize(size_t size) {
+    if (size > capacity()) {
+        throw std::length_error("PooledBuffer::resize exceeds capacity");
+    }
+    size_ = size;
+}
+
+static void recycleBlock(void* /*data*/, void* hint) {
+    PooledBuffer::Block::recycle(static_cast<PooledBuffer::Block*>(hint));
+}
+
+zmq::message_t makeMessage(PooledBuffer&& buffer) {
+    size_t size = buffer.size();
+    PooledBuffer::Block* block = buffer.release();
+    if (!block) {
+        return zmq::message_t();
+    }
+    // ZMQ 发送完成后在 I/O 线程中回调 recycleBlock，块随之回到池中
+    return zmq::message_t(block->payload(), size, &recycleBlock, block);
+}
+
+PooledBuffer::Block* PooledBuffer::release() {
+    Block* block = block_;
+    block_ = nullptr;
+    size_ = 0;
+    return block;
+}
+
+ZmqBufferPool::ZmqBufferPool(size_t block_size, size_t max_cached_blocks)
+    : state_(std::make_shared<State>()) {
+    state_->block_size = block_size;
+    state_->max_cached_blocks = max_cached_blocks;
+}
+
+ZmqBufferPool::~ZmqBufferPool() {
+    std::vector<PooledBuffer::Block*> blocks;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->closed = true;
+        blocks.swap(state_->free_blocks);
+    }
+    for (auto* block : blocks) {
+        PooledBuffer::Block::destroy(block);
+    }
+}
+
+PooledBuffer ZmqBufferPool::acquire(size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (size <= state_->block_size && !state_->free_blocks.empty()) {
+            PooledBuffer::Block* block = state_->free_blocks.back();
+            state_->free_blocks.pop_back();
+            ++state_->reuses;
+            return PooledBuffer(block, size);
+        }
+        ++state_->allocations;
+    }
+    size_t capacity = size <= state_->block_size ? state_->block_size : size;
+    return PooledBuffer(PooledBuffer::Block::create(state_, capacity), size);
+}
+
+size_t ZmqBufferPool::blockSize() const {
+    return state_->block_size;
+}
+
+size_t ZmqBufferPool::cachedBlocks() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->free_blocks.size();
+}
+
+uint64_t ZmqBufferPool::allocations() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->allocations;
+}
+
+uint64_t ZmqBufferPool::reuses() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->reuses;
+}
+
+} // namespace zmq_component
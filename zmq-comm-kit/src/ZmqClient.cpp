@@ -2,29 +2,56 @@
 
 namespace zmq_component {
 
-ZmqClient::ZmqClient(const std::string& address) {
+ZmqClient::ZmqClient(const std::string& address, std::shared_ptr<zmq::context_t> context)
+    : ZmqInterface(std::move(context)) {
     setupSocket(ZMQ_REQ, address);
 }
 
-void ZmqClient::sendRequest(const std::string& message) {
-    zmq::message_t request(message.size());
-    memcpy(request.data(), message.data(), message.size());
-    if (!socket_->send(request, zmq::send_flags::none)) {
-        throw ZmqCommunicationError("Send timeout");
-    }
+void ZmqClient::sendRequest(std::string_view message) {
+    zmq::message_t request = makeMessage(message);
+    sendFrame(request);
+}
+
+void ZmqClient::sendRequest(const char* message) {
+    sendRequest(std::string_view(message));
+}
+
+void ZmqClient::sendRequest(std::string&& message) {
+    zmq::message_t request = makeMessage(std::move(message));
+    sendFrame(request);
+}
+
+void ZmqClient::sendRequest(PooledBuffer&& buffer) {
+    zmq::message_t request = makeMessage(std::move(buffer));
+    sendFrame(request);
+}
+
+void ZmqClient::sendRequest(zmq::message_t&& message) {
+    sendFrame(message);
 }
 
 std::string ZmqClient::receiveResponse() {
-    zmq::message_t reply;
-    if (!socket_->recv(reply)) {
-        throw ZmqCommunicationError("Receive timeout");
+    return receiveResponseMessage().to_string();
+}
+
+zmq::message_t ZmqClient::receiveResponseMessage() {
+    try {
+        return receiveFrame();
+    } catch (const ZmqCommunicationError&) {
+        // 超时后 REQ 套接字仍在等待回复，之后的每次发送都会失败；重建后才能继续使用
+        resetSocket();
+        throw;
     }
-    return {static_cast<char*>(reply.data()), reply.size()};
 }
 
 std::string ZmqClient::request(const std::string& message) {
-    sendRequest(message);
+    sendRequest(std::string_view(message));
     return receiveResponse();
 }
 
-} // namespace zmq_component
\ No newline at end of file
+zmq::message_t ZmqClient::request(zmq::message_t&& message) {
+    sendRequest(std::move(message));
+    return receiveResponseMessage();
+}
+
+} // namespace zmq_component
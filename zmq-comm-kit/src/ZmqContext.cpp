@@ -0,0 +1,34 @@
+#include "ZmqContext.h"
+
+namespace zmq_component {
+
+std::mutex ZmqContext::mutex_;
+std::weak_ptr<zmq::context_t> ZmqContext::instance_;
+int ZmqContext::io_threads_ = 1;
+
+void ZmqContext::setIoThreads(int io_threads) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    io_threads_ = io_threads > 0 ? io_threads : 1;
+}
+
+int ZmqContext::ioThreads() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return io_threads_;
+}
+
+std::shared_ptr<zmq::context_t> ZmqContext::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto context = instance_.lock();
+    if (!context) {
+        context = std::make_shared<zmq::context_t>(io_threads_);
+        instance_ = context;
+    }
+    return context;
+}
+
+long ZmqContext::useCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return instance_.use_count();
+}
+
+} // namespace zmq_component
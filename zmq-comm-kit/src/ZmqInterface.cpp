@@ -1,28 +1,86 @@
 #include "ZmqInterface.h"
+#include "ZmqContext.h"
+#include <algorithm>
+#include <chrono>
 
 namespace zmq_component {
 
 ZmqCommunicationError::ZmqCommunicationError(const std::string& what)
     : std::runtime_error("ZMQ Error: " + what) {}
 
+ZmqInterface::ZmqInterface(std::shared_ptr<zmq::context_t> context)
+    : context_(context ? std::move(context) : ZmqContext::acquire()) {}
+
 void ZmqInterface::setupSocket(int socket_type, const std::string& address) {
+    bool bind = (socket_type == ZMQ_REP || socket_type == ZMQ_PUB || socket_type == ZMQ_ROUTER);
+    setupSocket(socket_type, address, bind);
+}
+
+void ZmqInterface::setupSocket(int socket_type, const std::string& address, bool bind) {
+    socket_type_ = socket_type;
+    address_ = address;
+    bind_ = bind;
     try {
-        context_ = std::make_unique<zmq::context_t>(1);
         socket_ = std::make_unique<zmq::socket_t>(*context_, socket_type);
         
         socket_->set(zmq::sockopt::rcvtimeo, timeout_ms_);
         socket_->set(zmq::sockopt::sndtimeo, timeout_ms_);
 
-        (socket_type == ZMQ_REP) ? socket_->bind(address) 
-                                  : socket_->connect(address);
+        bind ? socket_->bind(address) 
+             : socket_->connect(address);
     } catch (const zmq::error_t& e) {
         throw ZmqCommunicationError(e.what());
     }
 }
 
+void ZmqInterface::resetSocket() {
+    if (socket_) {
+        socket_->set(zmq::sockopt::linger, 0);
+        socket_->close();
+        socket_.reset();
+    }
+    setupSocket(socket_type_, address_, bind_);
+}
+
+void ZmqInterface::sendFrame(zmq::message_t& message, zmq::send_flags flags) {
+    if (!socket_->send(message, flags)) {
+        throw ZmqCommunicationError("Send timeout");
+    }
+}
+
+zmq::message_t ZmqInterface::receiveFrame() {
+    zmq::message_t message;
+    if (!socket_->recv(message)) {
+        throw ZmqCommunicationError("Receive timeout");
+    }
+    return message;
+}
+
+bool ZmqInterface::waitReadable(int timeout_ms) {
+    using Clock = std::chrono::steady_clock;
+    constexpr long kInterruptCheckMs = 100;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!interrupted_) {
+        long slice = kInterruptCheckMs;
+        if (timeout_ms >= 0) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            slice = std::clamp<long>(remaining, 0, kInterruptCheckMs);
+        }
+        zmq::pollitem_t items[] = {{socket_->handle(), 0, ZMQ_POLLIN, 0}};
+        if (zmq::poll(items, 1, std::chrono::milliseconds(slice)) > 0 && (items[0].revents & ZMQ_POLLIN)) {
+            return true;
+        }
+        if (timeout_ms >= 0 && Clock::now() >= deadline) {
+            return false;
+        }
+    }
+    return false;
+}
+
 ZmqInterface::~ZmqInterface() {
+    // 上下文由所有组件共享，这里只关闭自己的套接字；
+    // 最后一个持有者释放 context_ 时上下文才会终止
     if (socket_) socket_->close();
-    if (context_) context_->close();
 }
 
 void ZmqInterface::setTimeout(int milliseconds) {
@@ -33,4 +91,20 @@ void ZmqInterface::setTimeout(int milliseconds) {
     }
 }
 
-} // namespace zmq_component
\ No newline at end of file
+void ZmqInterface::bind(const std::string& address) {
+    try {
+        socket_->bind(address);
+    } catch (const zmq::error_t& e) {
+        throw ZmqCommunicationError(e.what());
+    }
+}
+
+void ZmqInterface::connect(const std::string& address) {
+    try {
+        socket_->connect(address);
+    } catch (const zmq::error_t& e) {
+        throw ZmqCommunicationError(e.what());
+    }
+}
+
+} // namespace zmq_component
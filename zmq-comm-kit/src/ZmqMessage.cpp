@@ -0,0 +1,45 @@
+#include "ZmqMessage.h"
+
+namespace zmq_component {
+
+namespace {
+
+// 把容器搬到堆上由 ZMQ 持有，发送完成后在释放回调中销毁
+template <typename Container>
+zmq::message_t adoptContainer(Container&& data) {
+    if (data.empty()) {
+        return zmq::message_t();
+    }
+    auto* owned = new Container(std::move(data));
+    return zmq::message_t(
+        owned->data(), owned->size() * sizeof(typename Container::value_type),
+        [](void* /*data*/, void* hint) { delete static_cast<Container*>(hint); }, owned);
+}
+
+} // namespace
+
+zmq::message_t makeMessage(std::string&& data) {
+    return adoptContainer(std::move(data));
+}
+
+zmq::message_t makeMessage(std::vector<char>&& data) {
+    return adoptContainer(std::move(data));
+}
+
+zmq::message_t makeMessage(std::vector<float>&& data) {
+    return adoptContainer(std::move(data));
+}
+
+zmq::message_t makeMessage(std::vector<int16_t>&& data) {
+    return adoptContainer(std::move(data));
+}
+
+zmq::message_t makeMessage(std::string_view data) {
+    return zmq::message_t(data.data(), data.size());
+}
+
+zmq::message_t makeMessage(const char* data) {
+    return makeMessage(std::string_view(data));
+}
+
+} // namespace zmq_component
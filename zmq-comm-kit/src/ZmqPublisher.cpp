@@ -0,0 +1,23 @@
+#include "ZmqPublisher.h"
+
+namespace zmq_component {
+
+ZmqPublisher::ZmqPublisher(const std::string& address, std::shared_ptr<zmq::context_t> context)
+    : ZmqInterface(std::move(context)) {
+    setupSocket(ZMQ_PUB, address);
+}
+
+void ZmqPublisher::publish(const std::string& message) {
+    if (!socket_->send(zmq::buffer(message), zmq::send_flags::none)) {
+        throw ZmqCommunicationError("Send timeout");
+    }
+}
+
+void ZmqPublisher::publish(const std::string& topic, const std::string& payload) {
+    if (!socket_->send(zmq::buffer(topic), zmq::send_flags::sndmore) ||
+        !socket_->send(zmq::buffer(payload), zmq::send_flags::none)) {
+        throw ZmqCommunicationError("Send timeout");
+    }
+}
+
+} // namespace zmq_component
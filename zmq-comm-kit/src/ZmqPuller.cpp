@@ -0,0 +1,39 @@
+#include "ZmqPuller.h"
+
+namespace zmq_component {
+
+ZmqPuller::ZmqPuller(const std::string& address, std::shared_ptr<zmq::context_t> context)
+    : ZmqInterface(std::move(context)) {
+    setupSocket(ZMQ_PULL, address, true);
+}
+
+std::string ZmqPuller::receive() {
+    return receiveMessage().to_string();
+}
+
+zmq::message_t ZmqPuller::receiveMessage() {
+    return receiveFrame();
+}
+
+void ZmqPuller::receiveMultipart(std::vector<zmq::message_t>& parts) {
+    parts.clear();
+    do {
+        parts.push_back(receiveFrame());
+    } while (parts.back().more());
+}
+
+bool ZmqPuller::tryReceiveMultipart(std::vector<zmq::message_t>& parts) {
+    zmq::message_t first;
+    if (!socket_->recv(first, zmq::recv_flags::dontwait)) {
+        return false;
+    }
+    parts.clear();
+    parts.push_back(std::move(first));
+    // 多帧消息是原子送达的，首帧到达后其余帧已在本地，不会阻塞
+    while (parts.back().more()) {
+        parts.push_back(receiveFrame());
+    }
+    return true;
+}
+
+} // namespace zmq_component
@@ -0,0 +1,25 @@
+#include "ZmqPusher.h"
+
+namespace zmq_component {
+
+ZmqPusher::ZmqPusher(const std::string& address, std::shared_ptr<zmq::context_t> context)
+    : ZmqInterface(std::move(context)) {
+    setupSocket(ZMQ_PUSH, address, false);
+}
+
+void ZmqPusher::push(std::string_view message) {
+    zmq::message_t frame = makeMessage(message);
+    sendFrame(frame);
+}
+
+void ZmqPusher::push(zmq::message_t&& message) {
+    sendFrame(message);
+}
+
+void ZmqPusher::pushMultipart(std::vector<zmq::message_t>& parts) {
+    for (size_t i = 0; i < parts.size(); ++i) {
+        sendFrame(parts[i], i + 1 < parts.size() ? zmq::send_flags::sndmore : zmq::send_flags::none);
+    }
+}
+
+} // namespace zmq_component
@@ -0,0 +1,124 @@
+#include "ZmqReliableClient.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace zmq_component {
+
+ZmqReliableClient::ZmqReliableClient(const std::string& address, const RetryPolicy& policy,
+                                     std::shared_ptr<zmq::context_t> context)
+    : ZmqInterface(std::move(context)), policy_(policy) {
+    timeout_ms_ = policy_.timeout_ms;
+    setupSocket(ZMQ_DEALER, address, false);
+}
+
+void ZmqReliableClient::setRetryPolicy(const RetryPolicy& policy) {
+    policy_ = policy;
+    // 收发超时在建立套接字时设置，需要同步到当前套接字
+    setTimeout(policy_.timeout_ms);
+}
+
+std::string ZmqReliableClient::request(std::string_view message) {
+    return request(makeMessage(message)).to_string();
+}
+
+zmq::message_t ZmqReliableClient::request(zmq::message_t&& message) {
+    using Clock = std::chrono::steady_clock;
+    const uint64_t request_id = ++next_request_id_;
+    const auto start = Clock::now();
+    int backoff_ms = policy_.backoff_initial_ms;
+    ++stats_.requests;
+
+    for (int attempt = 0; attempt <= policy_.max_retries && !interrupted_; ++attempt) {
+        if (attempt > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+            backoff_ms = std::min(backoff_ms * 2, policy_.backoff_max_ms);
+            ++stats_.retries;
+        }
+
+        // 重试时需要再次发送同一负载：copy() 对大消息只增加引用计数，不复制数据
+        zmq::message_t payload;
+        payload.copy(message);
+
+        zmq::message_t reply;
+        auto deadline = Clock::now() + std::chrono::milliseconds(policy_.timeout_ms);
+        if (sendAttempt(request_id, payload) && awaitReply(request_id, deadline, reply)) {
+            double latency = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            ++stats_.successes;
+            stats_.last_latency_ms = latency;
+            stats_.total_latency_ms += latency;
+            stats_.max_latency_ms = std::max(stats_.max_latency_ms, latency);
+            return reply;
+        }
+
+        // 超时：对端可能已重启，旧连接上的排队消息和迟到回复一并丢弃
+        resetSocket();
+        ++stats_.reconnects;
+    }
+
+    ++stats_.failures;
+    if (interrupted_) {
+        throw ZmqCommunicationError("Request interrupted");
+    }
+    throw ZmqCommunicationError("Request timeout after " +
+                                std::to_string(policy_.max_retries + 1) + " attempts");
+}
+
+bool ZmqReliableClient::sendAttempt(uint64_t request_id, zmq::message_t& payload) {
+    try {
+        zmq::message_t id_frame(&request_id, sizeof(request_id));
+        zmq::message_t delimiter;
+        return socket_->send(id_frame, zmq::send_flags::sndmore) &&
+               socket_->send(delimiter, zmq::send_flags::sndmore) &&
+               socket_->send(payload, zmq::send_flags::none);
+    } catch (const zmq::error_t&) {
+        return false;
+    }
+}
+
+bool ZmqReliableClient::awaitReply(uint64_t request_id, std::chrono::steady_clock::time_point deadline,
+                                   zmq::message_t& reply) {
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            return false;
+        }
+        if (!waitReadable(static_cast<int>(remaining.count()))) {
+            return false;
+        }
+
+        // 回复格式: [请求ID][空帧][负载]
+        zmq::message_t id_frame;
+        zmq::message_t frame;
+        if (!socket_->recv(id_frame)) {
+            return false;
+        }
+        bool matched = id_frame.size() == sizeof(request_id) &&
+                       std::memcmp(id_frame.data(), &request_id, sizeof(request_id)) == 0;
+        bool complete = false;
+        while (socket_->get(zmq::sockopt::rcvmore)) {
+            if (!socket_->recv(frame)) {
+                return false;
+            }
+            if (frame.size() > 0 || !socket_->get(zmq::sockopt::rcvmore)) {
+                complete = true;
+                break;
+            }
+        }
+        // 负载之后若还有帧 (多帧回复)，一并读完，否则会残留在队列中被当作下一条回复的开头
+        zmq::message_t rest;
+        while (socket_->get(zmq::sockopt::rcvmore)) {
+            if (!socket_->recv(rest)) {
+                return false;
+            }
+        }
+        if (matched && complete) {
+            reply = std::move(frame);
+            return true;
+        }
+        ++stats_.late_replies_dropped;
+    }
+}
+
+} // namespace zmq_component
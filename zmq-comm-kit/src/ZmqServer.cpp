@@ -3,29 +3,48 @@
 namespace zmq_component
 {
 
-    ZmqServer::ZmqServer(const std::string &address)
+    ZmqServer::ZmqServer(const std::string &address, std::shared_ptr<zmq::context_t> context)
+        : ZmqInterface(std::move(context))
     {
         setupSocket(ZMQ_REP, address);
     }
 
     std::string ZmqServer::receive()
     {
-        zmq::message_t request;
-        if (!socket_->recv(request))
-        {
-            throw ZmqCommunicationError("Receive timeout");
-        }
-        return {static_cast<char *>(request.data()), request.size()};
+        return receiveMessage().to_string();
     }
 
-    void ZmqServer::send(const std::string &response)
+    zmq::message_t ZmqServer::receiveMessage()
     {
-        zmq::message_t reply(response.size());
-        memcpy(reply.data(), response.data(), response.size());
-        if (!socket_->send(reply, zmq::send_flags::none))
-        {
-            throw ZmqCommunicationError("Send timeout");
-        }
+        return receiveFrame();
     }
 
-} // namespace zmq_component
\ No newline at end of file
+    void ZmqServer::send(std::string_view response)
+    {
+        zmq::message_t reply = makeMessage(response);
+        sendFrame(reply);
+    }
+
+    void ZmqServer::send(const char *response)
+    {
+        send(std::string_view(response));
+    }
+
+    void ZmqServer::send(std::string &&response)
+    {
+        zmq::message_t reply = makeMessage(std::move(response));
+        sendFrame(reply);
+    }
+
+    void ZmqServer::send(PooledBuffer &&buffer)
+    {
+        zmq::message_t reply = makeMessage(std::move(buffer));
+        sendFrame(reply);
+    }
+
+    void ZmqServer::send(zmq::message_t &&response)
+    {
+        sendFrame(response);
+    }
+
+} // namespace zmq_component
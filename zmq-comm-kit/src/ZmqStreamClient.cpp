@@ -0,0 +1,82 @@
+#include "ZmqStreamClient.h"
+#include <cstring>
+#include <vector>
+
+namespace zmq_component {
+
+bool ZmqResponseStream::next(zmq::message_t& chunk) {
+    while (!finished_) {
+        bool last = client_->receiveChunk(request_id_, chunk);
+        finished_ = last;
+        // 结束标志可能附带一个空数据块，不交给调用方
+        if (!last || chunk.size() > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ZmqStreamClient::ZmqStreamClient(const std::string& address, std::shared_ptr<zmq::context_t> context)
+    : ZmqInterface(std::move(context)) {
+    setupSocket(ZMQ_DEALER, address, false);
+}
+
+ZmqResponseStream ZmqStreamClient::stream(std::string_view message) {
+    return stream(makeMessage(message));
+}
+
+ZmqResponseStream ZmqStreamClient::stream(zmq::message_t&& message) {
+    if (interrupted_) {
+        throw ZmqCommunicationError("Request interrupted");
+    }
+    const uint64_t request_id = ++next_request_id_;
+    zmq::message_t id_frame(&request_id, sizeof(request_id));
+    zmq::message_t delimiter;
+    sendFrame(id_frame, zmq::send_flags::sndmore);
+    sendFrame(delimiter, zmq::send_flags::sndmore);
+    sendFrame(message);
+    return ZmqResponseStream(*this, request_id);
+}
+
+size_t ZmqStreamClient::request(std::string_view message, const ChunkHandler& on_chunk) {
+    ZmqResponseStream response = stream(message);
+    size_t chunks = 0;
+    zmq::message_t chunk;
+    while (response.next(chunk)) {
+        ++chunks;
+        if (!on_chunk(chunk.to_string_view())) {
+            break;
+        }
+    }
+    return chunks;
+}
+
+bool ZmqStreamClient::receiveChunk(uint64_t request_id, zmq::message_t& chunk) {
+    while (true) {
+        // 多帧消息整体到达，可读后其余帧不会再等待
+        if (!waitReadable(timeout_ms_)) {
+            throw ZmqCommunicationError(interrupted_ ? "Request interrupted" : "Receive timeout");
+        }
+        std::vector<zmq::message_t> frames;
+        do {
+            frames.push_back(receiveFrame());
+        } while (frames.back().more());
+
+        // [请求ID][空帧][标志][数据块] 或 REP 服务端的 [请求ID][空帧][负载]
+        bool matched = frames.size() >= 3 && frames[0].size() == sizeof(request_id) &&
+                       std::memcmp(frames[0].data(), &request_id, sizeof(request_id)) == 0;
+        if (!matched) {
+            ++stale_chunks_dropped_;
+            continue;
+        }
+        if (frames.size() == 3) {
+            chunk = std::move(frames[2]);
+            return true;
+        }
+        const zmq::message_t& flag = frames[2];
+        chunk = std::move(frames[3]);
+        return flag.size() == 1 && *flag.data<char>() == kStreamEnd;
+    }
+}
+
+} // namespace zmq_component
@@ -0,0 +1,82 @@
+#include "ZmqStreamServer.h"
+
+namespace zmq_component
+{
+
+    ZmqStreamServer::ZmqStreamServer(const std::string &address, std::shared_ptr<zmq::context_t> context)
+        : ZmqInterface(std::move(context))
+    {
+        setupSocket(ZMQ_ROUTER, address);
+    }
+
+    ZmqStreamRequest ZmqStreamServer::receive()
+    {
+        ZmqStreamRequest request;
+        zmq::message_t frame = receiveFrame();
+        while (frame.more())
+        {
+            request.envelope_.push_back(std::move(frame));
+            frame = receiveFrame();
+        }
+        request.payload_ = std::move(frame);
+        return request;
+    }
+
+    void ZmqStreamServer::sendChunk(ZmqStreamRequest &request, std::string_view chunk)
+    {
+        zmq::message_t message = makeMessage(chunk);
+        sendFrames(request, kStreamMore, message);
+    }
+
+    void ZmqStreamServer::sendChunk(ZmqStreamRequest &request, const char *chunk)
+    {
+        sendChunk(request, std::string_view(chunk));
+    }
+
+    void ZmqStreamServer::sendChunk(ZmqStreamRequest &request, std::string &&chunk)
+    {
+        zmq::message_t message = makeMessage(std::move(chunk));
+        sendFrames(request, kStreamMore, message);
+    }
+
+    void ZmqStreamServer::sendChunk(ZmqStreamRequest &request, zmq::message_t &&chunk)
+    {
+        sendFrames(request, kStreamMore, chunk);
+    }
+
+    void ZmqStreamServer::finish(ZmqStreamRequest &request, std::string_view last_chunk)
+    {
+        zmq::message_t message = makeMessage(last_chunk);
+        sendFrames(request, kStreamEnd, message);
+    }
+
+    void ZmqStreamServer::finish(ZmqStreamRequest &request, const char *last_chunk)
+    {
+        finish(request, std::string_view(last_chunk));
+    }
+
+    void ZmqStreamServer::finish(ZmqStreamRequest &request, zmq::message_t &&last_chunk)
+    {
+        sendFrames(request, kStreamEnd, last_chunk);
+    }
+
+    void ZmqStreamServer::sendFrames(ZmqStreamRequest &request, char flag, zmq::message_t &chunk)
+    {
+        if (request.finished_)
+        {
+            throw ZmqCommunicationError("Stream response already finished");
+        }
+        // 信封帧每个数据块都要发送一次，copy() 只增加引用计数
+        for (auto &frame : request.envelope_)
+        {
+            zmq::message_t copy;
+            copy.copy(frame);
+            sendFrame(copy, zmq::send_flags::sndmore);
+        }
+        zmq::message_t flag_frame(&flag, 1);
+        sendFrame(flag_frame, zmq::send_flags::sndmore);
+        sendFrame(chunk);
+        request.finished_ = (flag == kStreamEnd);
+    }
+
+} // namespace zmq_component
@@ -0,0 +1,54 @@
+#include "ZmqSubscriber.h"
+
+namespace zmq_component {
+
+ZmqSubscriber::ZmqSubscriber(const std::string& address, const std::string& topic,
+                             std::shared_ptr<zmq::context_t> context)
+    : ZmqInterface(std::move(context)) {
+    setupSocket(ZMQ_SUB, address);
+    subscribe(topic);
+}
+
+void ZmqSubscriber::subscribe(const std::string& topic) {
+    socket_->set(zmq::sockopt::subscribe, topic);
+}
+
+void ZmqSubscriber::unsubscribe(const std::string& topic) {
+    socket_->set(zmq::sockopt::unsubscribe, topic);
+}
+
+std::string ZmqSubscriber::receive() {
+    zmq::message_t message;
+    if (!socket_->recv(message)) {
+        throw ZmqCommunicationError("Receive timeout");
+    }
+    return message.to_string();
+}
+
+bool ZmqSubscriber::tryReceive(std::string& message) {
+    zmq::message_t msg;
+    if (!socket_->recv(msg, zmq::recv_flags::dontwait)) {
+        return false;
+    }
+    message = msg.to_string();
+    return true;
+}
+
+bool ZmqSubscriber::tryReceive(std::string& topic, std::string& payload) {
+    zmq::message_t msg;
+    if (!socket_->recv(msg, zmq::recv_flags::dontwait)) {
+        return false;
+    }
+    topic = msg.to_string();
+    payload.clear();
+    // 多帧消息是原子送达的，首帧到达后其余帧已可读
+    while (msg.more()) {
+        if (!socket_->recv(msg, zmq::recv_flags::none)) {
+            throw ZmqCommunicationError("Receive timeout");
+        }
+        payload = msg.to_string();
+    }
+    return true;
+}
+
+} // namespace zmq_component
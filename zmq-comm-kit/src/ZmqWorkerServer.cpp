@@ -0,0 +1,274 @@
+#include "ZmqWorkerServer.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <string>
+
+namespace zmq_component
+{
+
+    namespace
+    {
+        std::atomic<uint64_t> g_instance_counter{0};
+
+        // 工作线程 (REQ) 启动后发送的第一条消息，表示可以领取请求
+        constexpr char kWorkerReady[] = "READY";
+
+        // 一条完整请求：信封帧 (客户端路由ID、请求ID、空分隔帧等) + 最后一帧负载
+        struct PendingRequest
+        {
+            std::vector<zmq::message_t> envelope;
+            zmq::message_t payload;
+        };
+
+        bool receiveRequest(zmq::socket_t &socket, PendingRequest &request)
+        {
+            zmq::message_t frame;
+            if (!socket.recv(frame, zmq::recv_flags::dontwait))
+            {
+                return false;
+            }
+            while (frame.more())
+            {
+                request.envelope.push_back(std::move(frame));
+                if (!socket.recv(frame))
+                {
+                    return false;
+                }
+            }
+            request.payload = std::move(frame);
+            return true;
+        }
+
+        // 读取一条完整的多帧消息
+        void receiveFrames(zmq::socket_t &socket, std::vector<zmq::message_t> &frames)
+        {
+            do
+            {
+                frames.emplace_back();
+                if (!socket.recv(frames.back()))
+                {
+                    frames.pop_back();
+                    return;
+                }
+            } while (frames.back().more());
+        }
+    } // namespace
+
+    ZmqWorkerServer::ZmqWorkerServer(const std::string &address, Handler handler, size_t num_workers,
+                                     std::shared_ptr<zmq::context_t> context)
+        : ZmqInterface(std::move(context)), handler_(std::move(handler))
+    {
+        setupSocket(ZMQ_ROUTER, address);
+
+        uint64_t id = ++g_instance_counter;
+        backend_address_ = "inproc://zmq-worker-server-" + std::to_string(id);
+        control_address_ = "inproc://zmq-worker-control-" + std::to_string(id);
+        try
+        {
+            backend_ = std::make_unique<zmq::socket_t>(*context_, zmq::socket_type::router);
+            backend_->bind(backend_address_);
+            control_ = std::make_unique<zmq::socket_t>(*context_, zmq::socket_type::pair);
+            control_->bind(control_address_);
+        }
+        catch (const zmq::error_t &e)
+        {
+            throw ZmqCommunicationError(e.what());
+        }
+
+        if (num_workers == 0)
+        {
+            num_workers = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (size_t i = 0; i < num_workers; ++i)
+        {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+    }
+
+    ZmqWorkerServer::~ZmqWorkerServer()
+    {
+        stop();
+        if (control_)
+            control_->close();
+        if (backend_)
+            backend_->close();
+    }
+
+    void ZmqWorkerServer::start()
+    {
+        if (running_)
+        {
+            return;
+        }
+        running_ = true;
+        stopping_ = false;
+        for (auto &worker : workers_)
+        {
+            worker->thread = std::thread(&ZmqWorkerServer::runWorker, this, std::ref(*worker));
+        }
+        broker_ = std::thread(&ZmqWorkerServer::runBroker, this);
+    }
+
+    void ZmqWorkerServer::stop()
+    {
+        if (!running_)
+        {
+            return;
+        }
+        // 中转线程收到 TERMINATE 后退出
+        zmq::socket_t command(*context_, zmq::socket_type::pair);
+        command.connect(control_address_);
+        command.send(zmq::str_buffer("TERMINATE"), zmq::send_flags::none);
+        if (broker_.joinable())
+        {
+            broker_.join();
+        }
+        command.close();
+
+        stopping_ = true;
+        for (auto &worker : workers_)
+        {
+            if (worker->thread.joinable())
+            {
+                worker->thread.join();
+            }
+        }
+        running_ = false;
+    }
+
+    std::vector<ZmqWorkerServer::WorkerStats> ZmqWorkerServer::workerStats() const
+    {
+        std::vector<WorkerStats> stats;
+        stats.reserve(workers_.size());
+        for (const auto &worker : workers_)
+        {
+            WorkerStats s;
+            s.handled = worker->handled;
+            s.errors = worker->errors;
+            s.busy_ms = worker->busy_us / 1000.0;
+            stats.push_back(s);
+        }
+        return stats;
+    }
+
+    void ZmqWorkerServer::runBroker()
+    {
+        // 后端消息: [工作线程ID][空帧][READY] 或 [工作线程ID][空帧][客户端信封...][回复]
+        std::deque<std::string> idle_workers;
+        std::deque<PendingRequest> pending;
+        try
+        {
+            while (true)
+            {
+                zmq::pollitem_t items[] = {{control_->handle(), 0, ZMQ_POLLIN, 0},
+                                           {backend_->handle(), 0, ZMQ_POLLIN, 0},
+                                           {socket_->handle(), 0, ZMQ_POLLIN, 0}};
+                zmq::poll(items, 3, std::chrono::milliseconds(-1));
+                if (items[0].revents & ZMQ_POLLIN)
+                {
+                    zmq::message_t command;
+                    (void)control_->recv(command);
+                    break;
+                }
+                if (items[1].revents & ZMQ_POLLIN)
+                {
+                    std::vector<zmq::message_t> frames;
+                    receiveFrames(*backend_, frames);
+                    if (frames.size() >= 3)
+                    {
+                        idle_workers.push_back(frames[0].to_string());
+                        if (frames.size() > 3)
+                        {
+                            for (size_t i = 2; i + 1 < frames.size(); ++i)
+                            {
+                                socket_->send(frames[i], zmq::send_flags::sndmore);
+                            }
+                            socket_->send(frames.back(), zmq::send_flags::none);
+                        }
+                    }
+                }
+                if (items[2].revents & ZMQ_POLLIN)
+                {
+                    PendingRequest request;
+                    while (receiveRequest(*socket_, request))
+                    {
+                        pending.push_back(std::move(request));
+                        request = PendingRequest();
+                    }
+                    if (pending.size() > max_queue_depth_)
+                    {
+                        max_queue_depth_ = pending.size();
+                    }
+                }
+
+                // 每个空闲的工作线程领取一个请求
+                while (!idle_workers.empty() && !pending.empty())
+                {
+                    PendingRequest &request = pending.front();
+                    zmq::message_t worker_id(idle_workers.front());
+                    zmq::message_t delimiter;
+                    backend_->send(worker_id, zmq::send_flags::sndmore);
+                    backend_->send(delimiter, zmq::send_flags::sndmore);
+                    for (auto &frame : request.envelope)
+                    {
+                        backend_->send(frame, zmq::send_flags::sndmore);
+                    }
+                    backend_->send(request.payload, zmq::send_flags::none);
+                    idle_workers.pop_front();
+                    pending.pop_front();
+                }
+                queue_depth_ = pending.size();
+            }
+        }
+        catch (const zmq::error_t &)
+        {
+            // 上下文被终止时以 ETERM 返回
+        }
+        queue_depth_ = 0;
+    }
+
+    void ZmqWorkerServer::runWorker(Worker &worker)
+    {
+        // REQ 套接字一问一答：回复发出后才会收到下一个请求，中转线程据此知道该线程又空闲了
+        zmq::socket_t socket(*context_, zmq::socket_type::req);
+        socket.set(zmq::sockopt::linger, 0);
+        socket.connect(backend_address_);
+        socket.send(zmq::str_buffer(kWorkerReady), zmq::send_flags::none);
+
+        while (!stopping_)
+        {
+            zmq::pollitem_t items[] = {{socket.handle(), 0, ZMQ_POLLIN, 0}};
+            zmq::poll(items, 1, std::chrono::milliseconds(100));
+            PendingRequest current;
+            if (!receiveRequest(socket, current))
+            {
+                continue;
+            }
+
+            zmq::message_t reply;
+            auto begin = std::chrono::steady_clock::now();
+            try
+            {
+                reply = handler_(current.payload);
+            }
+            catch (...)
+            {
+                // 任何异常都要回复，否则客户端一直等待
+                reply.rebuild();
+                ++worker.errors;
+            }
+            worker.busy_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                                  std::chrono::steady_clock::now() - begin)
+                                  .count();
+            ++worker.handled;
+
+            for (auto &frame : current.envelope)
+            {
+                socket.send(frame, zmq::send_flags::sndmore);
+            }
+            socket.send(reply, zmq::send_flags::none);
+        }
+    }
+
+} // namespace zmq_component
@@ -1,7 +1,51 @@
 #include "ZmqServer.h"
 #include "ZmqClient.h"
+#include "ZmqContext.h"
+#include "ZmqStreamServer.h"
+#include "ZmqWorkerServer.h"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <thread>
+#include <vector>
+
+// 多个客户端并发请求 CPU 密集型处理函数，打印每秒完成的请求数
+static void workerServerThroughput(size_t num_workers)
+{
+    const std::string address = "inproc://demo-workers-" + std::to_string(num_workers);
+    zmq_component::ZmqWorkerServer server(address, [](zmq::message_t &request)
+                                          {
+        // 模拟约 2ms 的计算
+        volatile double x = 0;
+        auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(2);
+        while (std::chrono::steady_clock::now() < until)
+            x = x + 1.0;
+        return zmq::message_t(request.data(), request.size()); },
+                                          num_workers);
+    server.start();
+
+    const int clients = 8;
+    const int requests_per_client = 25;
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; ++c)
+    {
+        threads.emplace_back([&]
+                             {
+            zmq_component::ZmqClient client(address);
+            for (int i = 0; i < requests_per_client; ++i)
+                client.request("work"); });
+    }
+    for (auto &t : threads)
+        t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    size_t max_depth = server.maxQueueDepth();
+    server.stop();
+    std::cout << "Worker server (" << num_workers << " workers): "
+              << static_cast<int>(clients * requests_per_client / seconds) << " req/s, max queue depth "
+              << max_depth << std::endl;
+}
 
 int main()
 {
@@ -22,6 +66,40 @@ int main()
         std::cout << "Client received: " << response << std::endl;
 
         server_thread.join();
+
+        // 进程内组件共享同一个上下文，通过 inproc:// 通信，不经过 TCP 协议栈
+        zmq_component::ZmqServer inproc_server("inproc://demo");
+        zmq_component::ZmqClient inproc_client("inproc://demo");
+        std::thread inproc_thread([&]
+                                  {
+            auto request = inproc_server.receive();
+            inproc_server.send("Echo: " + request); });
+
+        std::cout << "Inproc client received: " << inproc_client.request("Hello inproc!")
+                  << " (shared context users: " << zmq_component::ZmqContext::useCount() << ")"
+                  << std::endl;
+
+        inproc_thread.join();
+
+        // 流式响应：服务端分块回复，客户端边收边处理
+        zmq_component::ZmqStreamServer stream_server("inproc://demo-stream");
+        zmq_component::ZmqStreamClient stream_client("inproc://demo-stream");
+        std::thread stream_thread([&]
+                                  {
+            auto request = stream_server.receive();
+            stream_server.sendChunk(request, "Echo: ");
+            stream_server.sendChunk(request, request.text());
+            stream_server.finish(request, "!"); });
+
+        std::cout << "Stream client received:";
+        for (auto &chunk : stream_client.stream("Hello stream"))
+            std::cout << " [" << chunk.to_string_view() << "]";
+        std::cout << std::endl;
+        stream_thread.join();
+
+        // ROUTER/DEALER 多工作线程服务端：吞吐随工作线程数增长
+        workerServerThroughput(1);
+        workerServerThroughput(std::max(2u, std::thread::hardware_concurrency()));
     }
     catch (const std::exception &e)
     {
@@ -29,4 +107,4 @@ int main()
         return 1;
     }
     return 0;
-}
\ No newline at end of file
+}